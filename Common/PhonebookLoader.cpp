@@ -0,0 +1,221 @@
+/*
+Parallel phonebook file loader shared by the phonebook projects.
+Written by Hagverdi Ibrahimli
+
+The contact file is memory-mapped and split into one chunk per thread at newline boundaries.
+Every thread copies its chunk into one contiguous text buffer, folds it to upper case (16 bytes at a time with SSE2
+where available) and tokenizes its lines. The result is a contiguous array of records whose fields point into the
+buffer, which each project turns into its own contact type with contacts<T>().
+A line holds one contact: first name, last name, phone number and city separated by whitespace.
+Lines with fewer than four fields are skipped, extra fields are ignored.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LOADER_MIN_CHUNK_SIZE (1 << 20) //files smaller than this are loaded by a single thread
+
+//Fields of a phonebook line, also used as bit flags to choose which fields are folded to upper case
+enum PhonebookField {
+	FIELD_FIRST_NAME = 1,
+	FIELD_LAST_NAME = 2,
+	FIELD_PHONE_NUMBER = 4,
+	FIELD_CITY = 8,
+};
+
+#define UPPERCASE_NAMES (FIELD_FIRST_NAME | FIELD_LAST_NAME)
+#define UPPERCASE_NAMES_AND_CITY (FIELD_FIRST_NAME | FIELD_LAST_NAME | FIELD_CITY)
+
+struct PhonebookRecord {
+	const char* field[4]; //firstName, lastName, phoneNumber, city; points into the loader's text buffer
+	uint32_t length[4];
+};
+
+//ASCII upper-casing of [begin, end); bytes outside 'a'..'z' are left as they are, like toupper in the "C" locale
+inline void foldToUpper(char* begin, char* end) {
+#if defined(__SSE2__) || defined(_M_X64)
+	const __m128i beforeA = _mm_set1_epi8('a' - 1);
+	const __m128i afterZ = _mm_set1_epi8('z' + 1);
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	for (; end - begin >= 16; begin += 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		//bytes >= 0x80 are negative in the signed compare, so they are never treated as lower case
+		__m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(block, beforeA), _mm_cmplt_epi8(block, afterZ));
+		block = _mm_sub_epi8(block, _mm_and_si128(isLower, caseBit));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(begin), block);
+	}
+#endif
+	for (; begin < end; begin++) {
+		if (*begin >= 'a' && *begin <= 'z')
+			*begin -= 0x20;
+	}
+}
+
+inline bool isFieldSeparator(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+class PhonebookFile {
+public:
+	PhonebookFile() : textSize(0) {}
+
+	//Loads the file; uppercaseFields is a combination of PhonebookField flags, threadCount 0 picks one per core
+	bool load(const string& fileName, int uppercaseFields, int threadCount = 0) {
+		records.clear();
+		string_view source;
+		if (!mapFile(fileName, source))
+			return false;
+		textSize = source.size();
+		text.reset(new char[textSize + 1]);
+
+		if (threadCount <= 0)
+			threadCount = max(1u, thread::hardware_concurrency());
+		threadCount = max<size_t>(1, min<size_t>(threadCount, textSize / LOADER_MIN_CHUNK_SIZE));
+		//chunk i covers [bounds[i], bounds[i + 1]), every boundary is moved to the start of a line
+		vector<size_t> bounds(threadCount + 1, textSize);
+		bounds[0] = 0;
+		for (int i = 1; i < threadCount; i++) {
+			size_t pos = max(bounds[i - 1], textSize / threadCount * i);
+			while (pos < textSize && source[pos - 1] != '\n')
+				pos++;
+			bounds[i] = pos;
+		}
+
+		vector<vector<PhonebookRecord>> chunkRecords(threadCount);
+		vector<thread> workers;
+		for (int i = 1; i < threadCount; i++)
+			workers.push_back(thread(&PhonebookFile::loadChunk, this, source.data(), bounds[i], bounds[i + 1], uppercaseFields, ref(chunkRecords[i])));
+		loadChunk(source.data(), bounds[0], bounds[1], uppercaseFields, chunkRecords[0]);
+		for (thread& worker : workers)
+			worker.join();
+		unmapFile(source);
+
+		size_t total = 0;
+		for (const vector<PhonebookRecord>& chunk : chunkRecords)
+			total += chunk.size();
+		records.reserve(total);
+		for (const vector<PhonebookRecord>& chunk : chunkRecords)
+			records.insert(records.end(), chunk.begin(), chunk.end());
+		return true;
+	}
+	size_t size() const {
+		return records.size();
+	}
+	const PhonebookRecord& operator[](size_t index) const {
+		return records[index];
+	}
+	string_view field(size_t index, PhonebookField which) const {
+		int i = (which == FIELD_FIRST_NAME) ? 0 : (which == FIELD_LAST_NAME) ? 1 : (which == FIELD_PHONE_NUMBER) ? 2 : 3;
+		return string_view(records[index].field[i], records[index].length[i]);
+	}
+	//Builds the contacts of a project, T must be constructible from (firstName, lastName, phoneNumber, city)
+	template <class T>
+	vector<T> contacts() const {
+		vector<T> result;
+		result.reserve(records.size());
+		for (const PhonebookRecord& r : records)
+			result.push_back(T(string(r.field[0], r.length[0]), string(r.field[1], r.length[1]),
+				string(r.field[2], r.length[2]), string(r.field[3], r.length[3])));
+		return result;
+	}
+private:
+	unique_ptr<char[]> text; //upper-cased copy of the file, every record points into it
+	size_t textSize;
+	vector<PhonebookRecord> records;
+#ifdef _WIN32
+	string fileBuffer;
+#endif
+
+	void loadChunk(const char* source, size_t begin, size_t end, int uppercaseFields, vector<PhonebookRecord>& out) {
+		char* chunk = text.get();
+		memcpy(chunk + begin, source + begin, end - begin);
+		if (uppercaseFields != 0)
+			foldToUpper(chunk + begin, chunk + end);
+		size_t pos = begin;
+		while (pos < end) {
+			PhonebookRecord record;
+			int fieldCount = 0;
+			//split one line into its fields
+			while (pos < end && chunk[pos] != '\n') {
+				if (isFieldSeparator(chunk[pos])) {
+					pos++;
+					continue;
+				}
+				size_t start = pos;
+				while (pos < end && !isFieldSeparator(chunk[pos]))
+					pos++;
+				if (fieldCount < 4) {
+					record.field[fieldCount] = chunk + start;
+					record.length[fieldCount] = pos - start;
+				}
+				fieldCount++;
+			}
+			pos++;
+			if (fieldCount < 4)
+				continue;
+			//the whole chunk was folded in bulk; put back the fields that keep their original case
+			for (int i = 0; i < 4; i++) {
+				if (uppercaseFields != 0 && !(uppercaseFields & (1 << i)))
+					memcpy(const_cast<char*>(record.field[i]), source + (record.field[i] - chunk), record.length[i]);
+			}
+			out.push_back(record);
+		}
+	}
+
+	bool mapFile(const string& fileName, string_view& source) {
+#ifdef _WIN32
+		ifstream inFile(fileName, ios::binary);
+		if (!inFile.is_open())
+			return false;
+		fileBuffer.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+		source = string_view(fileBuffer);
+		return true;
+#else
+		int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		bool mapped = false;
+		if (fstat(fd, &info) == 0) {
+			if (info.st_size == 0) {
+				source = string_view();
+				mapped = true;
+			}
+			else {
+				void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED) {
+					madvise(data, info.st_size, MADV_SEQUENTIAL);
+					source = string_view(static_cast<const char*>(data), info.st_size);
+					mapped = true;
+				}
+			}
+		}
+		::close(fd);
+		return mapped;
+#endif
+	}
+	void unmapFile(string_view source) {
+#ifdef _WIN32
+		fileBuffer.clear();
+#else
+		if (!source.empty())
+			munmap(const_cast<char*>(source.data()), source.size());
+#endif
+	}
+};
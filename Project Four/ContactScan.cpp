@@ -0,0 +1,317 @@
+/*
+Implementation of the column scans over the contacts.
+Written by Hagverdi Ibrahimli
+
+searchSequential reads every Contact, whose names are strings of their own, so a scan jumps around memory and uses only
+a few of the bytes it loads. ContactColumns keeps the fields a scan reads in columns instead:
+    - the first SCAN_COLUMN_WIDTH chars of every first name and of every last name, zero padded to that width, so
+      prefix and exact name searches compare rows of the same size one after another
+    - the full names and the cities as text, one row after another and every row ended by '\n', for substring searches
+A scan runs one of three kernels on threadCount chunks of the rows at once (0 uses one thread per core):
+    SCAN_SCALAR   memcmp on every row, and a byte by byte search of the text
+    SCAN_SSE2     compares a row with the searched prefix in one 16-byte comparison; the text is searched 16 bytes at a
+                  time for the positions where both the first and the last char of the searched text are (Mula's
+                  SIMD-friendly substring search), and only those are compared in full
+    SCAN_AVX2     the same with 32-byte registers, two rows of a prefix column at once
+SSE2 is part of every x86-64 CPU; the AVX2 kernels are compiled for it with GCC's target attribute and only run when the
+CPU has it. Other compilers and CPUs, and searched texts too long for the padding, use the scalar kernel. A scan gives
+the rows found in order.
+*/
+
+#include <cstring>
+#include <thread>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CONTACT_SCAN_X86
+#include <immintrin.h>
+#endif
+
+#define SCAN_COLUMN_WIDTH 16 //chars of every first and last name in the prefix columns, one SSE register
+#define SCAN_TEXT_PADDING 64 //zero bytes after the text, which the vector loads at its end read
+
+enum ScanKernel {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2,
+};
+
+enum ScanField {
+    SCAN_FULL_NAME,
+    SCAN_CITY,
+};
+
+bool scanKernelSupported(ScanKernel kernel) {
+#if defined(CONTACT_SCAN_X86)
+    if (kernel == SCAN_AVX2)
+        return __builtin_cpu_supports("avx2");
+    if (kernel == SCAN_SSE2)
+        return true;
+#endif
+    return kernel == SCAN_SCALAR;
+}
+
+ScanKernel fastestScanKernel() {
+    if (scanKernelSupported(SCAN_AVX2))
+        return SCAN_AVX2;
+    return scanKernelSupported(SCAN_SSE2) ? SCAN_SSE2 : SCAN_SCALAR;
+}
+
+//a text column: the rows one after another, each ended by '\n'
+struct ScanText {
+    vector<char> text; //followed by SCAN_TEXT_PADDING zero bytes
+    vector<uint32_t> start; //start of every row, and the end of the text
+};
+
+//rows of [first, last) whose first compareBytes chars are those of pattern; the columns hold SCAN_COLUMN_WIDTH chars a row
+void scanPrefixScalar(const char* column, const char* pattern, size_t compareBytes, size_t first, size_t last,
+    vector<uint32_t>& rows) {
+    for (size_t row = first; row < last; row++)
+        if (memcmp(column + row * SCAN_COLUMN_WIDTH, pattern, compareBytes) == 0)
+            rows.push_back(row);
+}
+
+//rows of [first, last) whose text contains needle; the separators keep a match inside its row
+void scanTextScalar(const ScanText& column, const string& needle, size_t first, size_t last, vector<uint32_t>& rows) {
+    const char* text = column.text.data();
+    for (size_t row = first; row < last; row++) {
+        const size_t end = column.start[row + 1] - 1;
+        for (size_t i = column.start[row]; i + needle.size() <= end; i++) {
+            if (text[i] == needle[0] && memcmp(text + i, needle.data(), needle.size()) == 0) {
+                rows.push_back(row);
+                break;
+            }
+        }
+    }
+}
+
+#if defined(CONTACT_SCAN_X86)
+void scanPrefixSSE2(const char* column, const char* pattern, size_t compareBytes, size_t first, size_t last,
+    vector<uint32_t>& rows) {
+    const __m128i wanted = _mm_loadu_si128((const __m128i*)pattern);
+    const unsigned mask = (1u << compareBytes) - 1;
+    for (size_t row = first; row < last; row++) {
+        const __m128i chars = _mm_loadu_si128((const __m128i*)(column + row * SCAN_COLUMN_WIDTH));
+        if ((_mm_movemask_epi8(_mm_cmpeq_epi8(chars, wanted)) & mask) == mask)
+            rows.push_back(row);
+    }
+}
+
+__attribute__((target("avx2")))
+void scanPrefixAVX2(const char* column, const char* pattern, size_t compareBytes, size_t first, size_t last,
+    vector<uint32_t>& rows) {
+    const __m128i half = _mm_loadu_si128((const __m128i*)pattern);
+    const __m256i wanted = _mm256_set_m128i(half, half);
+    const uint32_t mask = (1u << compareBytes) - 1;
+    size_t row = first;
+    for (; row + 2 <= last; row += 2) {
+        const __m256i chars = _mm256_loadu_si256((const __m256i*)(column + row * SCAN_COLUMN_WIDTH));
+        const uint32_t equal = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, wanted));
+        if ((equal & mask) == mask)
+            rows.push_back(row);
+        if (((equal >> 16) & mask) == mask)
+            rows.push_back(row + 1);
+    }
+    scanPrefixScalar(column, pattern, compareBytes, row, last, rows);
+}
+
+//candidates is the block's bit mask of the positions where the first and the last char of needle are; the first one
+//that matches in full is added and the search continues at the row after it. False if none matches
+inline bool addTextMatch(const ScanText& column, const string& needle, size_t i, uint32_t candidates, size_t end,
+    size_t& row, vector<uint32_t>& rows) {
+    for (; candidates != 0; candidates &= candidates - 1) {
+        const size_t position = i + __builtin_ctz(candidates);
+        if (position + needle.size() > end)
+            return false;
+        if (memcmp(column.text.data() + position + 1, needle.data() + 1, needle.size() - 1) == 0) {
+            while (column.start[row + 1] <= position)
+                row++;
+            rows.push_back(row++);
+            return true;
+        }
+    }
+    return false;
+}
+
+//the blocks loaded at the last char of needle reach needle.size() - 1 + block - 1 bytes past the text at most
+inline bool fitsTextPadding(const string& needle, size_t block) {
+    return needle.size() - 1 + block - 1 <= SCAN_TEXT_PADDING;
+}
+
+void scanTextSSE2(const ScanText& column, const string& needle, size_t first, size_t last, vector<uint32_t>& rows) {
+    const __m128i firstChar = _mm_set1_epi8(needle[0]);
+    const __m128i lastChar = _mm_set1_epi8(needle.back());
+    const char* text = column.text.data();
+    const size_t end = column.start[last];
+    size_t row = first;
+    for (size_t i = column.start[first]; i < end;) {
+        const __m128i firstEqual = _mm_cmpeq_epi8(firstChar, _mm_loadu_si128((const __m128i*)(text + i)));
+        const __m128i lastEqual = _mm_cmpeq_epi8(lastChar, _mm_loadu_si128((const __m128i*)(text + i + needle.size() - 1)));
+        const uint32_t candidates = _mm_movemask_epi8(_mm_and_si128(firstEqual, lastEqual));
+        if (candidates != 0 && addTextMatch(column, needle, i, candidates, end, row, rows))
+            i = column.start[row];
+        else
+            i += 16;
+    }
+}
+
+__attribute__((target("avx2")))
+void scanTextAVX2(const ScanText& column, const string& needle, size_t first, size_t last, vector<uint32_t>& rows) {
+    const __m256i firstChar = _mm256_set1_epi8(needle[0]);
+    const __m256i lastChar = _mm256_set1_epi8(needle.back());
+    const char* text = column.text.data();
+    const size_t end = column.start[last];
+    size_t row = first;
+    for (size_t i = column.start[first]; i < end;) {
+        const __m256i firstEqual = _mm256_cmpeq_epi8(firstChar, _mm256_loadu_si256((const __m256i*)(text + i)));
+        const __m256i lastEqual = _mm256_cmpeq_epi8(lastChar, _mm256_loadu_si256((const __m256i*)(text + i + needle.size() - 1)));
+        const uint32_t candidates = _mm256_movemask_epi8(_mm256_and_si256(firstEqual, lastEqual));
+        if (candidates != 0 && addTextMatch(column, needle, i, candidates, end, row, rows))
+            i = column.start[row];
+        else
+            i += 32;
+    }
+}
+#endif
+
+class ContactColumns {
+public:
+    //contacts must outlive the columns
+    explicit ContactColumns(const vector<Contact>& contacts) : contacts(contacts),
+        firstNames(contacts.size() * SCAN_COLUMN_WIDTH, 0), lastNames(contacts.size() * SCAN_COLUMN_WIDTH, 0) {
+        for (size_t row = 0; row < contacts.size(); row++) {
+            const Contact& contact = contacts[row];
+            contact.firstName.copy(&firstNames[row * SCAN_COLUMN_WIDTH], SCAN_COLUMN_WIDTH);
+            contact.lastName.copy(&lastNames[row * SCAN_COLUMN_WIDTH], SCAN_COLUMN_WIDTH);
+            appendRow(fullNames, contact.firstName + " " + contact.lastName);
+            appendRow(cities, contact.city);
+        }
+        endText(fullNames);
+        endText(cities);
+    }
+
+    size_t size() const {
+        return contacts.size();
+    }
+    //bytes a prefix or name scan compares
+    size_t prefixColumnBytes() const {
+        return contacts.size() * SCAN_COLUMN_WIDTH;
+    }
+    //bytes a substring scan of the field searches
+    size_t textBytes(ScanField field) const {
+        return text(field).start.back();
+    }
+    //rows whose first name starts with prefix
+    vector<uint32_t> firstNamePrefixRows(const string& prefix, ScanKernel kernel, int threadCount = 0) const {
+        return scanInChunks(threadCount, [&](size_t first, size_t last, vector<uint32_t>& rows) {
+            scanNameColumn(&Contact::firstName, prefix, false, kernel, first, last, rows);
+        });
+    }
+    //rows with the full name firstName + " " + lastName
+    vector<uint32_t> fullNameRows(const string& firstName, const string& lastName, ScanKernel kernel, int threadCount = 0) const {
+        return scanInChunks(threadCount, [&](size_t first, size_t last, vector<uint32_t>& rows) {
+            //the rows with the first name are few, so their last names are compared one by one
+            vector<uint32_t> candidates;
+            scanNameColumn(&Contact::firstName, firstName, true, kernel, first, last, candidates);
+            for (uint32_t row : candidates) {
+                const char* chars = &lastNames[row * SCAN_COLUMN_WIDTH];
+                if (lastName.size() < SCAN_COLUMN_WIDTH ? lastName.compare(0, string::npos, chars, strnlen(chars, SCAN_COLUMN_WIDTH)) == 0
+                    : contacts[row].lastName == lastName)
+                    rows.push_back(row);
+            }
+        });
+    }
+    //rows whose field contains needle
+    vector<uint32_t> substringRows(ScanField field, const string& needle, ScanKernel kernel, int threadCount = 0) const {
+        const ScanText& column = text(field);
+        //a row cannot contain its separator
+        if (needle.find('\n') != string::npos)
+            return vector<uint32_t>();
+        return scanInChunks(threadCount, [&](size_t first, size_t last, vector<uint32_t>& rows) {
+            if (needle.empty()) {
+                for (size_t row = first; row < last; row++)
+                    rows.push_back(row);
+            }
+#if defined(CONTACT_SCAN_X86)
+            else if (kernel == SCAN_AVX2 && fitsTextPadding(needle, 32))
+                scanTextAVX2(column, needle, first, last, rows);
+            else if (kernel == SCAN_SSE2 && fitsTextPadding(needle, 16))
+                scanTextSSE2(column, needle, first, last, rows);
+#endif
+            else
+                scanTextScalar(column, needle, first, last, rows);
+        });
+    }
+    vector<Contact> contactsOf(const vector<uint32_t>& rows) const {
+        vector<Contact> results;
+        results.reserve(rows.size());
+        for (uint32_t row : rows)
+            results.push_back(contacts[row]);
+        return results;
+    }
+private:
+    const vector<Contact>& contacts;
+    vector<char> firstNames;
+    vector<char> lastNames;
+    ScanText fullNames;
+    ScanText cities;
+
+    const ScanText& text(ScanField field) const {
+        return field == SCAN_CITY ? cities : fullNames;
+    }
+    static void appendRow(ScanText& column, const string& row) {
+        column.start.push_back(column.text.size());
+        column.text.insert(column.text.end(), row.begin(), row.end());
+        column.text.push_back('\n');
+    }
+    static void endText(ScanText& column) {
+        column.start.push_back(column.text.size());
+        column.text.resize(column.text.size() + SCAN_TEXT_PADDING, 0);
+    }
+    //rows of [first, last) whose field, a first or a last name, starts with name, or is name if exact; names longer
+    //than the column are checked in full on the contacts
+    void scanNameColumn(string Contact::* field, const string& name, bool exact, ScanKernel kernel, size_t first,
+        size_t last, vector<uint32_t>& rows) const {
+        const vector<char>& column = field == &Contact::firstName ? firstNames : lastNames;
+        //an exact name also compares the zero after it, unless it fills the column
+        const size_t compareBytes = min<size_t>(SCAN_COLUMN_WIDTH, name.size() + exact);
+        if (compareBytes == 0) {
+            for (size_t row = first; row < last; row++)
+                rows.push_back(row);
+            return;
+        }
+        char pattern[SCAN_COLUMN_WIDTH] = {};
+        name.copy(pattern, SCAN_COLUMN_WIDTH);
+        const size_t found = rows.size();
+#if defined(CONTACT_SCAN_X86)
+        if (kernel == SCAN_AVX2)
+            scanPrefixAVX2(column.data(), pattern, compareBytes, first, last, rows);
+        else if (kernel == SCAN_SSE2)
+            scanPrefixSSE2(column.data(), pattern, compareBytes, first, last, rows);
+        else
+#endif
+            scanPrefixScalar(column.data(), pattern, compareBytes, first, last, rows);
+        if (name.size() >= SCAN_COLUMN_WIDTH) {
+            rows.erase(remove_if(rows.begin() + found, rows.end(), [&](uint32_t row) {
+                const string& value = contacts[row].*field;
+                return exact ? value != name : value.compare(0, name.size(), name) != 0;
+            }), rows.end());
+        }
+    }
+    //runs scan(first, last, rows) on threadCount chunks of the rows at once and gives the rows found, in order
+    template<class Scan>
+    vector<uint32_t> scanInChunks(int threadCount, Scan scan) const {
+        const size_t chunks = min<size_t>(parallelThreadCount(threadCount), max<size_t>(1, contacts.size()));
+        vector<vector<uint32_t>> found(chunks);
+        vector<thread> workers;
+        for (size_t chunk = 1; chunk < chunks; chunk++)
+            workers.push_back(thread([&, chunk] {
+                scan(contacts.size() * chunk / chunks, contacts.size() * (chunk + 1) / chunks, found[chunk]);
+            }));
+        scan(0, contacts.size() / chunks, found[0]);
+        for (thread& worker : workers)
+            worker.join();
+        for (size_t chunk = 1; chunk < chunks; chunk++)
+            found[0].insert(found[0].end(), found[chunk].begin(), found[chunk].end());
+        return found[0];
+    }
+};
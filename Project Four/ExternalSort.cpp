@@ -0,0 +1,387 @@
+/*
+Implementation of the external sort.
+Written by Hagverdi Ibrahimli
+
+Usage: sorting_algorithms --external-sort <contact file> <output file> [key=value ...]
+    memory=1024     megabytes the contacts, keys and buffers may take
+    threads=0       threads of the run sort, 0 uses one per core
+    tempdir=        directory of the run files, by default the directory of the output file
+run() and the loader hold the whole file in memory, several times over. The external sort never holds more than the
+memory limit, so it sorts files much larger than the memory of the machine, in two phases:
+    runs    the file is read in chunks that fit in the limit; every chunk is sorted through its keys with the
+            parallel merge sort and written to a run file
+    merge   the runs are merged by a loser tree: a tournament whose inner nodes keep the loser of their match, so the
+            next contact costs log2 k comparisons against the path of the last winner only. When there are more runs
+            than the limit gives buffers for, groups of them are merged into longer runs first
+All files are read and written through large buffers, the merge splits the limit evenly between its inputs and its output.
+The output holds one contact per line, "FIRSTNAME LASTNAME phone city", with the names upper-cased as in run(), sorted
+by full name; contacts with the same name keep their order in the file. Lines with fewer than four fields are skipped.
+*/
+
+#include <cstdio>
+#include <string_view>
+
+#define EXTERNAL_IO_BUFFER (4 << 20) //largest buffer of the input file and of a run file while the runs are made
+#define EXTERNAL_MIN_BUFFER (256 << 10) //smallest buffer of a merge input, bounds the runs merged at once
+#define EXTERNAL_MAX_FAN_IN 512 //most runs merged at once, well under the usual open file limit
+
+struct ExternalSortConfig {
+    string inputName;
+    string outputName;
+    size_t memory = (size_t)1024 << 20;
+    int threads = 0;
+    string tempDir;
+    string tempPrefix; //path of the run files without their number
+};
+
+//reads a file line by line through one buffer
+class BufferedLineReader {
+public:
+    explicit BufferedLineReader(size_t bufferSize) : file(NULL), buffer(bufferSize), begin(0), end(0), atEnd(false) {}
+    ~BufferedLineReader() {
+        if (file != NULL)
+            fclose(file);
+    }
+    BufferedLineReader(const BufferedLineReader&) = delete;
+    BufferedLineReader& operator=(const BufferedLineReader&) = delete;
+
+    bool open(const string& fileName) {
+        file = fopen(fileName.c_str(), "rb");
+        return file != NULL;
+    }
+    //the next line without its newline, valid until the next call; false at the end of the file
+    bool next(string_view& line) {
+        while (true) {
+            const char* newline = static_cast<const char*>(memchr(buffer.data() + begin, '\n', end - begin));
+            if (newline != NULL) {
+                line = string_view(buffer.data() + begin, newline - (buffer.data() + begin));
+                begin = newline - buffer.data() + 1;
+                return true;
+            }
+            if (atEnd) {
+                if (begin == end)
+                    return false;
+                line = string_view(buffer.data() + begin, end - begin);
+                begin = end;
+                return true;
+            }
+            //the partial line moves to the front; a line longer than the buffer grows it
+            memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+            if (end == buffer.size())
+                buffer.resize(buffer.size() * 2);
+            const size_t count = fread(buffer.data() + end, 1, buffer.size() - end, file);
+            end += count;
+            atEnd = count == 0;
+        }
+    }
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t begin, end; //unread bytes of the buffer
+    bool atEnd;
+};
+
+//writes a file through one buffer
+class BufferedWriter {
+public:
+    explicit BufferedWriter(size_t bufferSize) : file(NULL), failed(false) {
+        buffer.reserve(bufferSize);
+    }
+    ~BufferedWriter() {
+        close();
+    }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    bool open(const string& fileName) {
+        file = fopen(fileName.c_str(), "wb");
+        return file != NULL;
+    }
+    void write(string_view text) {
+        if (buffer.size() + text.size() > buffer.capacity())
+            flush();
+        if (text.size() > buffer.capacity())
+            failed |= fwrite(text.data(), 1, text.size(), file) != text.size();
+        else
+            buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+    void writeContact(const Contact& contact) {
+        const string* fields[4] = { &contact.firstName, &contact.lastName, &contact.phoneNumber, &contact.city };
+        for (int i = 0; i < 4; i++) {
+            write(*fields[i]);
+            write(i < 3 ? " " : "\n");
+        }
+    }
+    //flushes and closes the file; false if anything could not be written
+    bool close() {
+        if (file == NULL)
+            return !failed;
+        flush();
+        failed |= fclose(file) != 0;
+        file = NULL;
+        return !failed;
+    }
+private:
+    FILE* file;
+    vector<char> buffer;
+    bool failed;
+
+    void flush() {
+        if (!buffer.empty())
+            failed |= fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+        buffer.clear();
+    }
+};
+
+//splits a line into a contact as the loader does, with the names upper-cased; false if it has fewer than four fields
+bool parseContactLine(string_view line, Contact& contact) {
+    string* fields[4] = { &contact.firstName, &contact.lastName, &contact.phoneNumber, &contact.city };
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++) {
+        while (pos < line.size() && isFieldSeparator(line[pos]))
+            pos++;
+        if (pos == line.size())
+            return false;
+        const size_t start = pos;
+        while (pos < line.size() && !isFieldSeparator(line[pos]))
+            pos++;
+        fields[i]->assign(line.data() + start, pos - start);
+    }
+    foldToUpper(&contact.firstName[0], &contact.firstName[0] + contact.firstName.size());
+    foldToUpper(&contact.lastName[0], &contact.lastName[0] + contact.lastName.size());
+    return true;
+}
+
+//bytes a contact takes in a chunk besides its place in the chunk's array: its key, its place in the merge buffer of the
+//keys, and the strings too long to be stored inside the string
+inline size_t chunkMemory(const Contact& contact) {
+    size_t bytes = 2 * sizeof(ContactKey);
+    const string* fields[4] = { &contact.firstName, &contact.lastName, &contact.phoneNumber, &contact.city };
+    for (const string* field : fields)
+        if (field->capacity() > string().capacity())
+            bytes += (field->capacity() + 1 + 8 + 15) & ~(size_t)15; //as malloc rounds the block with its header
+    return bytes;
+}
+
+//k-way merge of sorted run files by a loser tree
+class RunMerger {
+public:
+    RunMerger(const vector<string>& runNames, size_t bufferSize) : runNames(runNames), current(runNames.size()),
+        keys(runNames.size()), exhausted(runNames.size(), false), tree(runNames.size()) {
+        for (size_t i = 0; i < runNames.size(); i++)
+            readers.push_back(unique_ptr<BufferedLineReader>(new BufferedLineReader(bufferSize)));
+    }
+    //merges the runs into the writer; false if a run cannot be read
+    bool merge(BufferedWriter& writer) {
+        const int k = readers.size();
+        for (int i = 0; i < k; i++) {
+            if (!readers[i]->open(runNames[i])) {
+                cerr << "Error opening run file " << runNames[i] << "." << endl;
+                return false;
+            }
+            advance(i);
+        }
+        //every node starts with the virtual leaf k, which wins every match and is pushed out as the leaves enter
+        fill(tree.begin(), tree.end(), k);
+        for (int i = k - 1; i >= 0; i--)
+            replay(i);
+        while (!exhausted[tree[0]]) {
+            const int winner = tree[0];
+            writer.writeContact(current[winner]);
+            advance(winner);
+            replay(winner);
+        }
+        return true;
+    }
+private:
+    vector<string> runNames;
+    vector<unique_ptr<BufferedLineReader>> readers;
+    vector<Contact> current; //the next contact of every run
+    vector<ContactKey> keys;
+    vector<bool> exhausted;
+    vector<int> tree; //tree[0] is the winner, tree[1..k-1] the losers of the inner nodes; leaf i is at k + i
+
+    void advance(int run) {
+        string_view line;
+        while (readers[run]->next(line))
+            if (parseContactLine(line, current[run])) {
+                keys[run] = makeContactKey(current[run]);
+                return;
+            }
+        exhausted[run] = true;
+    }
+    //true if the current contact of run a comes before the one of run b; equal names come first from the earlier run
+    bool beats(int a, int b) const {
+        const int k = readers.size();
+        if (a == k || b == k)
+            return a == k;
+        if (exhausted[a] || exhausted[b])
+            return !exhausted[a] && (exhausted[b] || a < b);
+        if (isLess(keys[a], keys[b]))
+            return true;
+        return !isLess(keys[b], keys[a]) && a < b;
+    }
+    //plays the matches from leaf run up to the root
+    void replay(int run) {
+        const int k = readers.size();
+        int winner = run;
+        for (int node = (run + k) / 2; node > 0; node /= 2)
+            if (beats(tree[node], winner))
+                swap(tree[node], winner);
+        tree[0] = winner;
+    }
+};
+
+bool parseExternalSortArgs(int argc, char* argv[], ExternalSortConfig& config) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " --external-sort <contact file> <output file> [memory=MB] [threads=N] [tempdir=path]" << endl;
+        return false;
+    }
+    config.inputName = argv[2];
+    config.outputName = argv[3];
+    for (int i = 4; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = (eq == string::npos) ? "" : arg.substr(eq + 1);
+        //stoll and stoi throw on a value that is not a number or does not fit
+        try {
+            if (key == "memory" && !value.empty() && stoll(value) > 0 && stoll(value) <= (long long)(SIZE_MAX >> 20))
+                config.memory = (size_t)stoll(value) << 20;
+            else if (key == "threads" && !value.empty())
+                config.threads = stoi(value);
+            else if (key == "tempdir" && !value.empty())
+                config.tempDir = value;
+            else {
+                cerr << "Invalid external sort argument: " << arg << endl;
+                return false;
+            }
+        }
+        catch (const invalid_argument&) {
+            cerr << "Invalid external sort argument: " << arg << endl;
+            return false;
+        }
+        catch (const out_of_range&) {
+            cerr << "Invalid external sort argument: " << arg << endl;
+            return false;
+        }
+    }
+    //the runs are named after the output file, so sorts into different files can share a directory
+    size_t slash = config.outputName.find_last_of("/\\");
+    if (config.tempDir.empty())
+        config.tempDir = (slash == string::npos) ? "." : config.outputName.substr(0, slash);
+    config.tempPrefix = config.tempDir + "/" + config.outputName.substr(slash == string::npos ? 0 : slash + 1) + ".run";
+    return true;
+}
+
+//makes room in the chunk for one more contact if the limit allows it. The capacity of the chunk counts against the limit
+//together with the used bytes of its contacts; it doubles, or grows as far as the limit lets it while the old and the
+//new array are both held. A chunk always takes at least one contact
+bool makeChunkRoom(vector<Contact>& chunk, size_t used, size_t chunkLimit) {
+    if (chunk.size() < chunk.capacity())
+        return chunk.capacity() * sizeof(Contact) + used < chunkLimit;
+    const size_t slots = used < chunkLimit ? (chunkLimit - used) / sizeof(Contact) : 0;
+    size_t grown = min(max<size_t>(1024, 2 * chunk.capacity()), slots > chunk.capacity() ? slots - chunk.capacity() : 0);
+    if (grown <= chunk.capacity()) {
+        if (!chunk.empty())
+            return false;
+        grown = 1;
+    }
+    chunk.reserve(grown);
+    return true;
+}
+
+//sorts the input in chunks that fit in the memory limit into run files; with a single chunk the output is written at once
+bool makeRuns(const ExternalSortConfig& config, vector<string>& runNames, int& runCount) {
+    //the chunk gets what is left of the limit after the buffers of the input and of the run
+    const size_t ioBuffer = min<size_t>(EXTERNAL_IO_BUFFER, config.memory / 8);
+    const size_t chunkLimit = config.memory - 2 * ioBuffer;
+    BufferedLineReader reader(ioBuffer);
+    if (!reader.open(config.inputName)) {
+        cerr << "Error opening file. Please try again." << endl;
+        return false;
+    }
+    //the chunk keeps its capacity from one chunk to the next
+    vector<Contact> chunk;
+    string_view line;
+    Contact contact;
+    bool more = true;
+    while (more) {
+        chunk.clear();
+        size_t used = 0;
+        while (makeChunkRoom(chunk, used, chunkLimit) && (more = reader.next(line))) {
+            if (!parseContactLine(line, contact))
+                continue;
+            used += chunkMemory(contact);
+            chunk.push_back(move(contact));
+        }
+        if (chunk.empty() && !runNames.empty())
+            break;
+        vector<ContactKey> keys = makeContactKeys(chunk);
+        ParallelMergeSort<ContactKey>(config.threads).mergeSort(keys);
+        //a file that fits in one chunk needs no merge
+        const bool direct = !more && runNames.empty();
+        const string name = direct ? config.outputName : config.tempPrefix + to_string(runCount++);
+        BufferedWriter writer(ioBuffer);
+        if (!writer.open(name)) {
+            cerr << "Error creating " << name << "." << endl;
+            return false;
+        }
+        for (const ContactKey& key : keys)
+            writer.writeContact(*key.contact);
+        if (!writer.close()) {
+            cerr << "Error writing " << name << "." << endl;
+            return false;
+        }
+        if (direct)
+            return true;
+        runNames.push_back(name);
+        cout << "Run " << runNames.size() << ": " << chunk.size() << " contacts" << endl;
+    }
+    return true;
+}
+
+int runExternalSort(int argc, char* argv[]) {
+    ExternalSortConfig config;
+    if (!parseExternalSortArgs(argc, argv, config))
+        return 1;
+    auto startTime = chrono::steady_clock::now();
+    vector<string> runNames;
+    int runCount = 0;
+    if (!makeRuns(config, runNames, runCount))
+        return 1;
+    const size_t fanIn = max<size_t>(2, min<size_t>(EXTERNAL_MAX_FAN_IN, config.memory / EXTERNAL_MIN_BUFFER - 1));
+    //groups of runs are merged into longer runs until one merge can take them all
+    while (!runNames.empty()) {
+        const bool last = runNames.size() <= fanIn;
+        vector<string> merged;
+        for (size_t first = 0; first < runNames.size(); first += fanIn) {
+            const vector<string> group(runNames.begin() + first, runNames.begin() + min(runNames.size(), first + fanIn));
+            const size_t bufferSize = config.memory / (group.size() + 1);
+            const string name = last ? config.outputName : config.tempPrefix + to_string(runCount++);
+            BufferedWriter writer(bufferSize);
+            if (!writer.open(name)) {
+                cerr << "Error creating " << name << "." << endl;
+                return 1;
+            }
+            if (!RunMerger(group, bufferSize).merge(writer))
+                return 1;
+            if (!writer.close()) {
+                cerr << "Error writing " << name << "." << endl;
+                return 1;
+            }
+            for (const string& run : group)
+                remove(run.c_str());
+            merged.push_back(name);
+        }
+        cout << "Merged " << runNames.size() << " runs into " << merged.size() << endl;
+        if (last)
+            break;
+        runNames.swap(merged);
+    }
+    cout << "Sorted " << config.inputName << " into " << config.outputName << " in "
+        << chrono::duration<double>(chrono::steady_clock::now() - startTime).count() << " seconds" << endl;
+    return 0;
+}
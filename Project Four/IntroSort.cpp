@@ -0,0 +1,177 @@
+/*
+Implementation of the introspective quicksort.
+Written by Hagverdi Ibrahimli
+
+QuickSort picks the median of three and recurses without a bound, so inputs built against it take O(n^2) time and
+O(n) stack. IntroSort guards the same scheme:
+    - the recursion depth is bounded by 2 log2 n; a range that reaches the bound is heap sorted, so the sort is O(n log n)
+    - the smaller part is sorted recursively and the larger one in the loop, so the stack is O(log n)
+    - ranges longer than NINTHER_THRESHOLD take the median of three medians of three (Tukey's ninther) as the pivot
+    - elements equal to the pivot are gathered in the middle by a three-way (Dutch national flag) partition and are
+      not sorted again, so a dump with many repeated names takes O(n log k) for k distinct names
+With blockPartition the ranges are partitioned in two instead, BlockQuicksort style: the misplaced elements of a block
+of INTRO_BLOCK elements from each end are found first, without branching on the comparisons, and then swapped in pairs.
+A range whose pivot equals the element before it, which no element of the range can come before, holds many copies of
+the pivot and is partitioned in three as above (as pdqsort does).
+The sort is not stable.
+*/
+
+#include <cstdint>
+
+#define INTRO_SORT_CUTOFF 16 //ranges up to this size are insertion sorted
+#define NINTHER_THRESHOLD 128 //ranges longer than this take the ninther as the pivot
+#define INTRO_BLOCK 64 //elements of a block of the block partition
+
+template<class T>
+class IntroSort {
+public:
+    explicit IntroSort(bool blockPartition = false) : blockPartition(blockPartition) {}
+
+    void introSort(vector<T>& myVector) {
+        introSort(myVector, 0, myVector.size() - 1);
+    }
+
+    //sorts [left, right]
+    void introSort(vector<T>& myVector, int left, int right) {
+        if (left < right)
+            introSort(myVector, left, right, 2 * log2Floor(right - left + 1), true);
+    }
+private:
+    bool blockPartition;
+
+    static int log2Floor(int n) {
+        int log = 0;
+        while (n > 1) {
+            n >>= 1;
+            log++;
+        }
+        return log;
+    }
+    //leftmost is false if the element before left comes before none of [left, right]
+    void introSort(vector<T>& myVector, int left, int right, int depthLimit, bool leftmost) {
+        while (right - left + 1 > INTRO_SORT_CUTOFF) {
+            if (depthLimit == 0) {
+                HeapSort<T>().heapSort(myVector, left, right);
+                return;
+            }
+            depthLimit--;
+            choosePivot(myVector, left, right);
+            //the part before the pivot is [left, lessEnd] and the part after it [greaterStart, right]
+            int lessEnd, greaterStart;
+            if (blockPartition && (leftmost || isLess(myVector[left - 1], myVector[left])))
+                blockPartitionRange(myVector, left, right, lessEnd, greaterStart);
+            else
+                threeWayPartition(myVector, left, right, lessEnd, greaterStart);
+            if (lessEnd - left < right - greaterStart) {
+                introSort(myVector, left, lessEnd, depthLimit, leftmost);
+                left = greaterStart;
+                leftmost = false;
+            }
+            else {
+                introSort(myVector, greaterStart, right, depthLimit, false);
+                right = lessEnd;
+            }
+        }
+        InsertionSort<T>().insertionSort(myVector, left, right);
+    }
+    //index of the median of the elements at a, b and c
+    static int medianIndex(const vector<T>& myVector, int a, int b, int c) {
+        if (isLess(myVector[b], myVector[a]))
+            swapIndices(a, b);
+        if (isLess(myVector[c], myVector[b])) {
+            b = c;
+            if (isLess(myVector[b], myVector[a]))
+                b = a;
+        }
+        return b;
+    }
+    static void swapIndices(int& a, int& b) {
+        int temp = a;
+        a = b;
+        b = temp;
+    }
+    //moves the pivot of [left, right] to left
+    static void choosePivot(vector<T>& myVector, int left, int right) {
+        const int size = right - left + 1;
+        const int middle = left + size / 2;
+        int pivot;
+        if (size > NINTHER_THRESHOLD) {
+            const int step = size / 8;
+            pivot = medianIndex(myVector,
+                medianIndex(myVector, left, left + step, left + 2 * step),
+                medianIndex(myVector, middle - step, middle, middle + step),
+                medianIndex(myVector, right - 2 * step, right - step, right));
+        }
+        else
+            pivot = medianIndex(myVector, left, middle, right);
+        swap(myVector[left], myVector[pivot]);
+    }
+    //partitions [left, right] around the pivot at left into the elements before it, the elements equal to it and the
+    //elements after it
+    static void threeWayPartition(vector<T>& myVector, int left, int right, int& lessEnd, int& greaterStart) {
+        //the pivot stays at left until the last swap; [left + 1, less) come before it, [less, i) are equal to it
+        //and (greater, right] come after it
+        const T& pivot = myVector[left];
+        int less = left + 1, i = left + 1, greater = right;
+        while (i <= greater) {
+            if (isLess(myVector[i], pivot))
+                swap(myVector[less++], myVector[i++]);
+            else if (isLess(pivot, myVector[i]))
+                swap(myVector[i], myVector[greater--]);
+            else
+                i++;
+        }
+        swap(myVector[left], myVector[less - 1]);
+        lessEnd = less - 2;
+        greaterStart = greater + 1;
+    }
+    //partitions [left, right] around the pivot at left into the elements before it and the others
+    static void blockPartitionRange(vector<T>& myVector, int left, int right, int& lessEnd, int& greaterStart) {
+        const T& pivot = myVector[left];
+        //[left + 1, first) come before the pivot and (last, right] do not
+        int first = left + 1, last = right;
+        uint8_t offsetsLeft[INTRO_BLOCK], offsetsRight[INTRO_BLOCK];
+        int countLeft = 0, countRight = 0, startLeft = 0, startRight = 0;
+        while (last - first + 1 > 2 * INTRO_BLOCK) {
+            //the offset of every element is written, and the count only grows past the misplaced ones
+            if (countLeft == 0) {
+                startLeft = 0;
+                for (int k = 0; k < INTRO_BLOCK; k++) {
+                    offsetsLeft[countLeft] = k;
+                    countLeft += !isLess(myVector[first + k], pivot);
+                }
+            }
+            if (countRight == 0) {
+                startRight = 0;
+                for (int k = 0; k < INTRO_BLOCK; k++) {
+                    offsetsRight[countRight] = k;
+                    countRight += isLess(myVector[last - k], pivot);
+                }
+            }
+            const int count = min(countLeft, countRight);
+            for (int k = 0; k < count; k++)
+                swap(myVector[first + offsetsLeft[startLeft + k]], myVector[last - offsetsRight[startRight + k]]);
+            countLeft -= count;
+            countRight -= count;
+            startLeft += count;
+            startRight += count;
+            if (countLeft == 0)
+                first += INTRO_BLOCK;
+            if (countRight == 0)
+                last -= INTRO_BLOCK;
+        }
+        //a block with misplaced elements left over is still inside [first, last], which is partitioned element by element
+        while (true) {
+            while (first <= last && isLess(myVector[first], pivot))
+                first++;
+            while (first <= last && !isLess(myVector[last], pivot))
+                last--;
+            if (first > last)
+                break;
+            swap(myVector[first++], myVector[last--]);
+        }
+        swap(myVector[left], myVector[first - 1]);
+        lessEnd = first - 2;
+        greaterStart = first;
+    }
+};
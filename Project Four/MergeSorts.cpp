@@ -0,0 +1,275 @@
+/*
+Implementation of the buffered merge sorts.
+Written by Hagverdi Ibrahimli
+
+MergeSort merges in place by shifting, which moves O(n^2) elements. BufferedMergeSort merges through one auxiliary
+buffer reserved before the sort, moving the elements instead of copying them, in O(n log n):
+    mergeSort         bottom-up: blocks of MERGE_RUN elements are insertion sorted, then merged in rounds of doubling width
+    naturalMergeSort  TimSort-style: the ascending and descending runs already in the input are found, extended to a
+                      minimum length and merged following the run stack invariants, so partly sorted input takes fewer merges
+Every merge first skips the elements of either run that are already in place, and once one run wins MERGE_MIN_GALLOP
+times in a row the number of its elements that come next is found by galloping (exponential search) and moved at once.
+The shorter run of a merge is moved to the buffer, so it never needs more than n / 2 elements. The buffer can be limited
+further; a merge whose runs both exceed the limit is split with a rotation into two smaller merges (O(n log^2 n) moves),
+so a limit of 0 gives an in-place merge sort that needs no buffer.
+Both sorts are stable.
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+#define MERGE_RUN 32 //length of the blocks insertion sorted before the bottom-up merges
+#define MERGE_MIN_GALLOP 7 //consecutive wins of one run that switch a merge to galloping
+
+template<class T>
+class BufferedMergeSort {
+public:
+    //bufferLimit is the largest number of elements the auxiliary buffer may hold
+    explicit BufferedMergeSort(size_t bufferLimit = SIZE_MAX) : bufferLimit(bufferLimit) {}
+
+    void mergeSort(vector<T>& myVector) {
+        mergeSort(myVector, 0, myVector.size());
+    }
+    //sorts [first, last)
+    void mergeSort(vector<T>& myVector, size_t first, size_t last) {
+        reserveBuffer((last - first) / 2);
+        for (size_t left = first; left < last; left += MERGE_RUN)
+            InsertionSort<T>().insertionSort(myVector, left, min(left + MERGE_RUN, last) - 1);
+        for (size_t width = MERGE_RUN; width < last - first; width *= 2)
+            for (size_t left = first; left + width < last; left += 2 * width)
+                merge(myVector, left, left + width, min(left + 2 * width, last));
+    }
+
+    void naturalMergeSort(vector<T>& myVector) {
+        const size_t n = myVector.size();
+        reserveBuffer(n / 2);
+        const size_t minRun = minRunLength(n);
+        vector<Run> runs;
+        for (size_t start = 0; start < n;) {
+            size_t end = runEnd(myVector, start);
+            //a short run is extended with the following elements by insertion sort
+            if (end - start < minRun) {
+                size_t extended = min(start + minRun, n);
+                InsertionSort<T>().insertionSort(myVector, start, extended - 1);
+                end = extended;
+            }
+            runs.push_back(Run{ start, end - start });
+            start = end;
+            collapseRuns(myVector, runs, false);
+        }
+        collapseRuns(myVector, runs, true);
+    }
+private:
+    struct Run {
+        size_t start;
+        size_t length;
+    };
+    vector<T> buffer;
+    size_t bufferLimit;
+
+    void reserveBuffer(size_t elements) {
+        buffer.clear();
+        buffer.reserve(min(elements, bufferLimit));
+    }
+    //TimSort's minimum run length: n divided by a power of two into [32, 64), rounded up if any bit was shifted out
+    static size_t minRunLength(size_t n) {
+        size_t shiftedOut = 0;
+        while (n >= 64) {
+            shiftedOut |= n & 1;
+            n >>= 1;
+        }
+        return n + shiftedOut;
+    }
+    //end of the run starting at start; a strictly descending run is reversed, so that reversing keeps the sort stable
+    static size_t runEnd(vector<T>& myVector, size_t start) {
+        size_t end = start + 1;
+        if (end == myVector.size())
+            return end;
+        if (isLess(myVector[end], myVector[start])) {
+            while (end + 1 < myVector.size() && isLess(myVector[end + 1], myVector[end]))
+                end++;
+            reverse(myVector.begin() + start, myVector.begin() + end + 1);
+        }
+        else {
+            while (end + 1 < myVector.size() && !isLess(myVector[end + 1], myVector[end]))
+                end++;
+        }
+        return end + 1;
+    }
+    //merges runs from the top of the stack until the lengths, from the top down, grow faster than the Fibonacci numbers,
+    //which keeps the merges balanced and the stack O(log n); with all every run is merged
+    void collapseRuns(vector<T>& myVector, vector<Run>& runs, bool all) {
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if (all || (n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length)
+                || (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length)) {
+                if (n > 0 && runs[n - 1].length < runs[n + 1].length)
+                    n--;
+            }
+            else if (runs[n].length > runs[n + 1].length)
+                break;
+            merge(myVector, runs[n].start, runs[n + 1].start, runs[n + 1].start + runs[n + 1].length);
+            runs[n].length += runs[n + 1].length;
+            runs.erase(runs.begin() + n + 1);
+        }
+    }
+    //first position in [first, last) whose element is not before the searched one, where before(element) is true for a
+    //prefix of the range; the prefix is bracketed with steps of 1, 2, 4, ... from first and then binary searched
+    template <class Before>
+    static size_t gallop(const vector<T>& myVector, size_t first, size_t last, Before before) {
+        size_t step = 1;
+        size_t low = first;
+        while (first + step <= last && before(myVector[first + step - 1])) {
+            low = first + step;
+            step *= 2;
+        }
+        size_t high = min(first + step - 1, last);
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (before(myVector[middle]))
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+    //first position p in [first, last) with after(element) true on all of [p, last), where after is true for a suffix of the
+    //range; the suffix is bracketed with steps of 1, 2, 4, ... back from last and then binary searched
+    template <class After>
+    static size_t gallopBack(const vector<T>& myVector, size_t first, size_t last, After after) {
+        size_t step = 1;
+        size_t high = last;
+        while (last - first >= step && after(myVector[last - step])) {
+            high = last - step;
+            step *= 2;
+        }
+        size_t low = (last - first >= step) ? last - step + 1 : first;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (after(myVector[middle]))
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        return low;
+    }
+    //merges the sorted ranges [left, middle) and [middle, right)
+    void merge(vector<T>& myVector, size_t left, size_t middle, size_t right) {
+        if (left == middle || middle == right)
+            return;
+        //elements of the left run that do not come after the first of the right run are already in place,
+        //and so are the elements of the right run that do not come before the last of the left run
+        const T& firstRight = myVector[middle];
+        left = gallop(myVector, left, middle, [&](const T& element) { return !isLess(firstRight, element); });
+        if (left == middle)
+            return;
+        const T& lastLeft = myVector[middle - 1];
+        right = gallop(myVector, middle, right, [&](const T& element) { return isLess(element, lastLeft); });
+        if (middle - left <= right - middle && middle - left <= bufferLimit) {
+            mergeForward(myVector, left, middle, right);
+            return;
+        }
+        if (right - middle < middle - left && right - middle <= bufferLimit) {
+            mergeBackward(myVector, left, middle, right);
+            return;
+        }
+        //neither run fits in the buffer: the middle element of the longer run and its place in the other run split
+        //both runs in two, and the inner two parts swap places so that each half can be merged on its own
+        size_t cutLeft, cutRight;
+        if (middle - left >= right - middle) {
+            cutLeft = left + (middle - left) / 2;
+            const T& pivot = myVector[cutLeft];
+            cutRight = gallop(myVector, middle, right, [&](const T& element) { return isLess(element, pivot); });
+        }
+        else {
+            cutRight = middle + (right - middle) / 2;
+            const T& pivot = myVector[cutRight];
+            cutLeft = gallop(myVector, left, middle, [&](const T& element) { return !isLess(pivot, element); });
+        }
+        rotate(myVector.begin() + cutLeft, myVector.begin() + middle, myVector.begin() + cutRight);
+        const size_t newMiddle = cutLeft + (cutRight - middle);
+        merge(myVector, left, cutLeft, newMiddle);
+        merge(myVector, newMiddle, cutRight, right);
+    }
+    //moves the left run to the buffer and merges it with the right run into [left, right) from the front
+    void mergeForward(vector<T>& myVector, size_t left, size_t middle, size_t right) {
+        buffer.clear();
+        for (size_t i = left; i < middle; i++)
+            buffer.push_back(move(myVector[i]));
+        size_t a = 0, b = middle, out = left;
+        while (a < buffer.size() && b < right) {
+            int leftWins = 0, rightWins = 0;
+            do {
+                //equal elements are taken from the left run first, which keeps the merge stable
+                if (isLess(myVector[b], buffer[a])) {
+                    myVector[out++] = move(myVector[b++]);
+                    rightWins++;
+                    leftWins = 0;
+                }
+                else {
+                    myVector[out++] = move(buffer[a++]);
+                    leftWins++;
+                    rightWins = 0;
+                }
+            } while (a < buffer.size() && b < right && leftWins < MERGE_MIN_GALLOP && rightWins < MERGE_MIN_GALLOP);
+            if (a == buffer.size() || b == right)
+                break;
+            if (leftWins > 0) {
+                const T& next = myVector[b];
+                size_t end = gallop(buffer, a, buffer.size(), [&](const T& element) { return !isLess(next, element); });
+                while (a < end)
+                    myVector[out++] = move(buffer[a++]);
+            }
+            else {
+                const T& next = buffer[a];
+                size_t end = gallop(myVector, b, right, [&](const T& element) { return isLess(element, next); });
+                while (b < end)
+                    myVector[out++] = move(myVector[b++]);
+            }
+        }
+        //whatever is left of the right run is already in place
+        while (a < buffer.size())
+            myVector[out++] = move(buffer[a++]);
+    }
+    //moves the right run to the buffer and merges it with the left run into [left, right) from the back
+    void mergeBackward(vector<T>& myVector, size_t left, size_t middle, size_t right) {
+        buffer.clear();
+        for (size_t i = middle; i < right; i++)
+            buffer.push_back(move(myVector[i]));
+        //a, b and out are one past the next element of the buffer, of the left run and of the output
+        size_t a = buffer.size(), b = middle, out = right;
+        while (a > 0 && b > left) {
+            int leftWins = 0, rightWins = 0;
+            do {
+                //equal elements are taken from the right run first, which keeps the merge stable
+                if (isLess(buffer[a - 1], myVector[b - 1])) {
+                    myVector[--out] = move(myVector[--b]);
+                    leftWins++;
+                    rightWins = 0;
+                }
+                else {
+                    myVector[--out] = move(buffer[--a]);
+                    rightWins++;
+                    leftWins = 0;
+                }
+            } while (a > 0 && b > left && leftWins < MERGE_MIN_GALLOP && rightWins < MERGE_MIN_GALLOP);
+            if (a == 0 || b == left)
+                break;
+            if (rightWins > 0) {
+                const T& next = myVector[b - 1];
+                size_t start = gallopBack(buffer, 0, a, [&](const T& element) { return !isLess(element, next); });
+                while (a > start)
+                    myVector[--out] = move(buffer[--a]);
+            }
+            else {
+                const T& next = buffer[a - 1];
+                size_t start = gallopBack(myVector, left, b, [&](const T& element) { return isLess(next, element); });
+                while (b > start)
+                    myVector[--out] = move(myVector[--b]);
+            }
+        }
+        //whatever is left of the left run is already in place
+        while (a > 0)
+            myVector[--out] = move(buffer[--a]);
+    }
+};
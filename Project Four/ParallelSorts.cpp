@@ -0,0 +1,356 @@
+/*
+Implementation of the parallel sorts.
+Written by Hagverdi Ibrahimli
+
+The sorts run their work as tasks on a work-stealing pool: every thread has its own deque of tasks, takes the newest of
+its own tasks first and, when it has none, steals the oldest task of another thread, which is usually the largest.
+A thread waiting for its child tasks runs tasks meanwhile, so nested fork-join never blocks a thread.
+    ParallelQuickSort   partitions like QuickSort and forks the smaller part as a task above PARALLEL_SORT_CUTOFF;
+                        a range still longer after 2 log2 n partitions is left to IntroSort, so it stays O(n log n)
+    ParallelMergeSort   sorts both halves in parallel, then merges them in parallel: the output is cut into chunks and
+                        the co-rank of each cut (how many of its elements come from the left half) is binary searched,
+                        so every chunk is merged on its own; it is stable
+    ParallelSampleSort  picks splitters from a random sample, moves every element to its bucket with per-chunk counts
+                        and then sorts the buckets in parallel; meant for very large inputs
+The thread count is given to the constructor, 0 uses one thread per core.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#define PARALLEL_SORT_CUTOFF 8192 //ranges shorter than this are sorted by the thread that has them
+#define PARALLEL_MERGE_CHUNK 16384 //elements of the output merged by one task
+#define SAMPLE_OVERSAMPLING 32 //samples drawn per bucket of the sample sort
+#define SAMPLE_BUCKETS_PER_THREAD 4
+
+class WorkStealingPool {
+public:
+    //threadCount includes the thread that waits for the tasks, so threadCount - 1 workers are started
+    explicit WorkStealingPool(int threadCount) : queues(max(1, threadCount)), queued(0), stopping(false) {
+        for (size_t i = 1; i < queues.size(); i++)
+            workers.push_back(thread(&WorkStealingPool::work, this, i));
+    }
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (thread& worker : workers)
+            worker.join();
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    //adds the task to the calling thread's deque; threads outside the pool use the first one
+    void submit(function<void()> task) {
+        TaskQueue& queue = queues[currentIndex()];
+        {
+            lock_guard<mutex> lock(queue.lock);
+            queue.tasks.push_back(move(task));
+        }
+        queued++;
+        //taking the lock orders the count with a worker that is about to sleep, so the wakeup is not lost
+        { lock_guard<mutex> lock(sleepMutex); }
+        wakeUp.notify_one();
+    }
+    //runs one task, its own newest one or the oldest one of another thread; false if there was none
+    bool runOne() {
+        const size_t self = currentIndex();
+        function<void()> task;
+        for (size_t k = 0; k < queues.size() && !task; k++) {
+            TaskQueue& queue = queues[(self + k) % queues.size()];
+            lock_guard<mutex> lock(queue.lock);
+            if (queue.tasks.empty())
+                continue;
+            if (k == 0) {
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task)
+            return false;
+        queued--;
+        task();
+        return true;
+    }
+    int size() const {
+        return queues.size();
+    }
+private:
+    struct TaskQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    vector<TaskQueue> queues;
+    vector<thread> workers;
+    atomic<int> queued; //tasks in all the deques
+    mutex sleepMutex;
+    condition_variable wakeUp;
+    bool stopping;
+
+    static WorkStealingPool*& currentPool() {
+        thread_local WorkStealingPool* pool = NULL;
+        return pool;
+    }
+    static size_t& poolIndex() {
+        thread_local size_t index = 0;
+        return index;
+    }
+    size_t currentIndex() const {
+        return currentPool() == this ? poolIndex() : 0;
+    }
+    void work(size_t index) {
+        currentPool() = this;
+        poolIndex() = index;
+        while (true) {
+            if (runOne())
+                continue;
+            unique_lock<mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping)
+                return;
+        }
+    }
+};
+
+//Tasks forked on a pool that are waited for together
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool(pool), pending(0) {}
+    ~TaskGroup() {
+        wait();
+    }
+    void run(function<void()> task) {
+        pending++;
+        pool.submit([this, task] {
+            task();
+            pending--;
+        });
+    }
+    //runs tasks of the pool until every task of the group is done
+    void wait() {
+        while (pending > 0)
+            if (!pool.runOne())
+                this_thread::yield();
+    }
+private:
+    WorkStealingPool& pool;
+    atomic<int> pending;
+};
+
+inline int parallelThreadCount(int threadCount) {
+    return threadCount > 0 ? threadCount : max(1u, thread::hardware_concurrency());
+}
+
+template<class T>
+class ParallelQuickSort {
+public:
+    explicit ParallelQuickSort(int threadCount = 0) : threadCount(parallelThreadCount(threadCount)) {}
+
+    void quickSort(vector<T>& myVector) {
+        WorkStealingPool pool(threadCount);
+        TaskGroup group(pool);
+        int depthLimit = 0;
+        for (size_t n = myVector.size(); n > 1; n >>= 1)
+            depthLimit += 2;
+        quickSort(myVector, 0, (int)myVector.size() - 1, depthLimit, group);
+        group.wait();
+    }
+private:
+    int threadCount;
+
+    void quickSort(vector<T>& myVector, int left, int right, int depthLimit, TaskGroup& group) {
+        //the smaller part is forked and the larger one kept, so a thread never holds more than O(log n) ranges
+        while (right - left >= PARALLEL_SORT_CUTOFF && depthLimit > 0) {
+            int i, j;
+            QuickSort<T>().partition(myVector, left, right, i, j);
+            depthLimit--;
+            //unlike QuickSort's recursion the parts leave out the pivot, so that no element is shared by two threads
+            if (i - left < right - i) {
+                group.run([this, &myVector, left, i, depthLimit, &group] { quickSort(myVector, left, i - 1, depthLimit, group); });
+                left = i + 1;
+            }
+            else {
+                group.run([this, &myVector, i, right, depthLimit, &group] { quickSort(myVector, i + 1, right, depthLimit, group); });
+                right = i - 1;
+            }
+        }
+        IntroSort<T>().introSort(myVector, left, right);
+    }
+};
+
+template<class T>
+class ParallelMergeSort {
+public:
+    explicit ParallelMergeSort(int threadCount = 0) : threadCount(parallelThreadCount(threadCount)) {}
+
+    void mergeSort(vector<T>& myVector) {
+        vector<T> buffer(myVector.size());
+        WorkStealingPool pool(threadCount);
+        sort(myVector, buffer, 0, myVector.size(), false, pool);
+    }
+private:
+    int threadCount;
+
+    //sorts [left, right) of a, leaving the result in b if toBuffer and in a otherwise; the halves are sorted into the
+    //other vector, so every level merges from one vector into the other and nothing is copied back
+    void sort(vector<T>& a, vector<T>& b, size_t left, size_t right, bool toBuffer, WorkStealingPool& pool) {
+        if (right - left <= PARALLEL_SORT_CUTOFF) {
+            BufferedMergeSort<T>().mergeSort(a, left, right);
+            if (toBuffer)
+                for (size_t i = left; i < right; i++)
+                    b[i] = move(a[i]);
+            return;
+        }
+        const size_t middle = left + (right - left) / 2;
+        {
+            TaskGroup group(pool);
+            group.run([&] { sort(a, b, left, middle, !toBuffer, pool); });
+            sort(a, b, middle, right, !toBuffer, pool);
+        }
+        if (toBuffer)
+            parallelMerge(a, b, left, middle, right, pool);
+        else
+            parallelMerge(b, a, left, middle, right, pool);
+    }
+    //number of elements of the left run [left, middle) among the first k elements of the merge with [middle, right),
+    //where equal elements come from the left run first
+    static size_t coRank(const vector<T>& source, size_t left, size_t middle, size_t right, size_t k) {
+        const size_t leftLength = middle - left, rightLength = right - middle;
+        size_t low = k > rightLength ? k - rightLength : 0;
+        size_t high = min(k, leftLength);
+        while (low < high) {
+            size_t i = low + (high - low) / 2;
+            //the (i + 1)th element of the left run is among the first k if it does not come after the (k - i)th of the right
+            if (!isLess(source[middle + k - i - 1], source[left + i]))
+                low = i + 1;
+            else
+                high = i;
+        }
+        return low;
+    }
+    //merges [left, middle) and [middle, right) of source into the same positions of target, one task per chunk
+    void parallelMerge(vector<T>& source, vector<T>& target, size_t left, size_t middle, size_t right, WorkStealingPool& pool) {
+        //the chunk tasks move elements out of source, so every cut is found before the first task starts
+        const size_t chunkCount = (right - left + PARALLEL_MERGE_CHUNK - 1) / PARALLEL_MERGE_CHUNK;
+        vector<size_t> cuts(chunkCount + 1);
+        for (size_t c = 0; c <= chunkCount; c++)
+            cuts[c] = coRank(source, left, middle, right, min(c * PARALLEL_MERGE_CHUNK, right - left));
+        TaskGroup group(pool);
+        for (size_t c = 0; c < chunkCount; c++) {
+            const size_t start = c * PARALLEL_MERGE_CHUNK, end = min(start + PARALLEL_MERGE_CHUNK, right - left);
+            const size_t aStart = cuts[c], aStop = cuts[c + 1];
+            group.run([&source, &target, left, middle, start, end, aStart, aStop] {
+                size_t a = left + aStart;
+                size_t b = middle + (start - aStart);
+                const size_t aEnd = left + aStop;
+                const size_t bEnd = middle + (end - aStop);
+                size_t out = left + start;
+                while (a < aEnd && b < bEnd) {
+                    if (isLess(source[b], source[a]))
+                        target[out++] = move(source[b++]);
+                    else
+                        target[out++] = move(source[a++]);
+                }
+                while (a < aEnd)
+                    target[out++] = move(source[a++]);
+                while (b < bEnd)
+                    target[out++] = move(source[b++]);
+            });
+        }
+    }
+};
+
+template<class T>
+class ParallelSampleSort {
+public:
+    explicit ParallelSampleSort(int threadCount = 0, unsigned seed = 1) : threadCount(parallelThreadCount(threadCount)), seed(seed) {}
+
+    void sampleSort(vector<T>& myVector) {
+        const size_t n = myVector.size();
+        const size_t bucketCount = (size_t)threadCount * SAMPLE_BUCKETS_PER_THREAD;
+        if (n <= PARALLEL_SORT_CUTOFF || bucketCount < 2) {
+            IntroSort<T>().introSort(myVector);
+            return;
+        }
+        WorkStealingPool pool(threadCount);
+        //bucket b holds the elements between splitters b - 1 and b; equal elements go to the same bucket
+        vector<T> sample;
+        mt19937 generator(seed);
+        for (size_t i = 0; i < bucketCount * SAMPLE_OVERSAMPLING; i++)
+            sample.push_back(myVector[uniform_int_distribution<size_t>(0, n - 1)(generator)]);
+        IntroSort<T>().introSort(sample);
+        vector<T> splitters;
+        for (size_t b = 1; b < bucketCount; b++)
+            splitters.push_back(move(sample[b * SAMPLE_OVERSAMPLING]));
+
+        //every chunk counts its elements per bucket, remembering the bucket of each element
+        const size_t chunkCount = (n + PARALLEL_MERGE_CHUNK - 1) / PARALLEL_MERGE_CHUNK;
+        vector<uint32_t> bucketOf(n);
+        vector<size_t> counts(chunkCount * bucketCount, 0);
+        {
+            TaskGroup group(pool);
+            for (size_t c = 0; c < chunkCount; c++)
+                group.run([&, c] {
+                    for (size_t i = c * PARALLEL_MERGE_CHUNK; i < min(n, (c + 1) * PARALLEL_MERGE_CHUNK); i++) {
+                        bucketOf[i] = bucketIndex(splitters, myVector[i]);
+                        counts[c * bucketCount + bucketOf[i]]++;
+                    }
+                });
+        }
+        //the elements of bucket b from chunk c start after those of the earlier buckets and of bucket b from earlier chunks
+        vector<size_t> offsets(chunkCount * bucketCount);
+        vector<size_t> bucketStart(bucketCount + 1, 0);
+        size_t position = 0;
+        for (size_t b = 0; b < bucketCount; b++) {
+            bucketStart[b] = position;
+            for (size_t c = 0; c < chunkCount; c++) {
+                offsets[c * bucketCount + b] = position;
+                position += counts[c * bucketCount + b];
+            }
+        }
+        bucketStart[bucketCount] = n;
+        vector<T> buckets(n);
+        {
+            TaskGroup group(pool);
+            for (size_t c = 0; c < chunkCount; c++)
+                group.run([&, c] {
+                    for (size_t i = c * PARALLEL_MERGE_CHUNK; i < min(n, (c + 1) * PARALLEL_MERGE_CHUNK); i++)
+                        buckets[offsets[c * bucketCount + bucketOf[i]]++] = move(myVector[i]);
+                });
+        }
+        {
+            TaskGroup group(pool);
+            for (size_t b = 0; b < bucketCount; b++)
+                if (bucketStart[b + 1] - bucketStart[b] > 1)
+                    group.run([&, b] { IntroSort<T>().introSort(buckets, bucketStart[b], bucketStart[b + 1] - 1); });
+        }
+        myVector.swap(buckets);
+    }
+private:
+    int threadCount;
+    unsigned seed;
+
+    //number of splitters that do not come after the element
+    static uint32_t bucketIndex(const vector<T>& splitters, const T& element) {
+        size_t low = 0, high = splitters.size();
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (isLess(element, splitters[middle]))
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        return low;
+    }
+};
@@ -0,0 +1,231 @@
+/*
+Implementation of the static search index over the sorted contacts.
+Written by Hagverdi Ibrahimli
+
+searchBinary reads a contact, in a different part of memory, at every step of its binary search. ContactSearchIndex is
+built once after the sort and keeps the first 8 chars of every full name packed into an integer (as in ContactKey), and
+the next 8 chars in a second one, so the search runs over 16-byte keys and reads contacts only to tell apart the few
+names that share their first 16 chars.
+The position of the first key that is not smaller than the searched one is found with one of three layouts:
+    SEARCH_EYTZINGER      the keys in the order of a breadth-first walk of the binary search tree, so the first levels
+                          share cache lines and the keys three levels down are prefetched while the current one is read
+    SEARCH_SAMPLED        every SEARCH_SAMPLE_STRIDE-th key in a small array that stays in cache; it is binary
+                          searched, and only the block of the key array between two samples is scanned
+    SEARCH_INTERPOLATION  the first two chars select a bucket of the key array, and the place inside the bucket is
+                          interpolated from its first and last keys and then corrected by exponential search
+search() answers the same queries as searchBinary: all contacts whose first name starts with the query when there is no
+last name, and otherwise a contact with that full name, the first one if there are several.
+*/
+
+#include <cstdint>
+
+#define SEARCH_SAMPLE_STRIDE 32 //keys between two samples of the sampled layout
+#define EYTZINGER_PREFETCH_LEVELS 3 //levels ahead the Eytzinger search prefetches, the 2^3 keys there fill two cache lines
+
+enum SearchIndexLayout {
+    SEARCH_EYTZINGER,
+    SEARCH_SAMPLED,
+    SEARCH_INTERPOLATION,
+};
+
+//the first 16 chars of a name, packed into two integers like ContactKey::prefix; the keys order like the names
+struct NameKey {
+    uint64_t prefix; //chars 0 to 7
+    uint64_t suffix; //chars 8 to 15
+};
+
+inline bool operator<(const NameKey& key1, const NameKey& key2) {
+    return key1.prefix < key2.prefix || (key1.prefix == key2.prefix && key1.suffix < key2.suffix);
+}
+inline bool operator==(const NameKey& key1, const NameKey& key2) {
+    return key1.prefix == key2.prefix && key1.suffix == key2.suffix;
+}
+
+//chars from to from + 7 of the first length chars of firstName + " " + lastName, packed like ContactKey::prefix
+uint64_t packNameChars(const string& firstName, const string& lastName, size_t length, size_t from) {
+    uint64_t packed = 0;
+    for (size_t i = from; i < from + 8; i++)
+        packed = (packed << 8) | (i < length ? (uint8_t)(fullNameAt(firstName, lastName, i) ^ 0x80) : 0);
+    return packed;
+}
+
+NameKey makeNameKey(const string& firstName, const string& lastName, size_t length) {
+    return NameKey{ packNameChars(firstName, lastName, length, 0), packNameChars(firstName, lastName, length, 8) };
+}
+
+//a name searched for: the first length chars of firstName + " " + lastName, which are only the first name for a
+//search by first name
+struct NameQuery {
+    string firstName;
+    string lastName;
+    size_t length;
+    NameKey key;
+};
+
+NameQuery makeNameQuery(const string& firstName, const string& lastName) {
+    const size_t length = lastName.empty() ? firstName.size() : firstName.size() + 1 + lastName.size();
+    return NameQuery{ firstName, lastName, length, makeNameKey(firstName, lastName, length) };
+}
+
+//compares the full name of the contact with the query as isSmaller would: negative if the contact comes first
+int compareName(const Contact& contact, const NameQuery& query) {
+    const size_t length = fullNameLength(contact);
+    for (size_t i = 0; i < length && i < query.length; i++) {
+        char l = fullNameAt(contact.firstName, contact.lastName, i);
+        char r = fullNameAt(query.firstName, query.lastName, i);
+        if (l != r)
+            return l < r ? -1 : 1;
+    }
+    return length < query.length ? -1 : (length > query.length ? 1 : 0);
+}
+
+class ContactSearchIndex {
+public:
+    //contacts must be sorted by full name and outlive the index
+    ContactSearchIndex(const vector<Contact>& contacts, SearchIndexLayout layout) : contacts(contacts), layout(layout) {
+        keys.reserve(contacts.size());
+        for (const Contact& contact : contacts)
+            keys.push_back(makeNameKey(contact.firstName, contact.lastName, fullNameLength(contact)));
+        if (layout == SEARCH_EYTZINGER) {
+            eytzinger.resize(keys.size() + 1);
+            eytzingerRank.resize(keys.size() + 1);
+            buildEytzinger(0, 1);
+        }
+        else if (layout == SEARCH_SAMPLED) {
+            for (size_t i = 0; i < keys.size(); i += SEARCH_SAMPLE_STRIDE)
+                samples.push_back(keys[i]);
+        }
+        else {
+            bucketStart.assign(65537, 0);
+            for (const NameKey& key : keys)
+                bucketStart[(key.prefix >> 48) + 1]++;
+            for (size_t b = 0; b < 65536; b++)
+                bucketStart[b + 1] += bucketStart[b];
+        }
+    }
+
+    vector<Contact> search(const string& firstName, const string& lastName) const {
+        vector<Contact> results;
+        const NameQuery query = makeNameQuery(firstName, lastName);
+        size_t i = lowerBound(query);
+        if (lastName.empty()) {
+            for (; i < contacts.size() && contacts[i].firstName.compare(0, firstName.size(), firstName) == 0; i++)
+                results.push_back(contacts[i]);
+        }
+        else if (i < contacts.size() && compareName(contacts[i], query) == 0)
+            results.push_back(contacts[i]);
+        return results;
+    }
+    //position of the first contact whose full name does not come before the query
+    size_t lowerBound(const NameQuery& query) const {
+        size_t low = lowerBoundKey(query.key);
+        //the contacts whose key equals the query's share their first 16 chars and are told apart by their names
+        size_t high = low;
+        for (size_t step = 1; high < keys.size() && keys[high] == query.key; step *= 2)
+            high = min(keys.size(), high + step);
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (compareName(contacts[middle], query) < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+private:
+    const vector<Contact>& contacts;
+    SearchIndexLayout layout;
+    vector<NameKey> keys; //the keys in sorted order
+    vector<NameKey> eytzinger; //from index 1, node k has children 2k and 2k + 1
+    vector<uint32_t> eytzingerRank; //position in keys of every node
+    vector<NameKey> samples;
+    vector<uint32_t> bucketStart; //first position of every value of the top 16 bits of the keys, and the end
+
+    //fills the subtree of node k in order with keys from i on and gives the next unused key
+    size_t buildEytzinger(size_t i, size_t k) {
+        if (k < eytzinger.size()) {
+            i = buildEytzinger(i, 2 * k);
+            eytzinger[k] = keys[i];
+            eytzingerRank[k] = i++;
+            i = buildEytzinger(i, 2 * k + 1);
+        }
+        return i;
+    }
+    //position of the first key that is not smaller than key
+    size_t lowerBoundKey(const NameKey& key) const {
+        if (layout == SEARCH_EYTZINGER)
+            return eytzingerLowerBound(key);
+        if (layout == SEARCH_SAMPLED)
+            return sampledLowerBound(key);
+        return interpolationLowerBound(key);
+    }
+    size_t eytzingerLowerBound(const NameKey& key) const {
+        const size_t n = keys.size();
+        size_t k = 1;
+        while (k <= n) {
+#if defined(__GNUC__)
+            const size_t ahead = k << EYTZINGER_PREFETCH_LEVELS;
+            if (ahead + 4 <= n) {
+                __builtin_prefetch(eytzinger.data() + ahead);
+                __builtin_prefetch(eytzinger.data() + ahead + 4);
+            }
+#endif
+            k = 2 * k + (eytzinger[k] < key);
+        }
+        //the last step to the left was taken at the answer: the right steps after it are the trailing ones of k
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+        return k == 0 ? n : eytzingerRank[k];
+    }
+    size_t sampledLowerBound(const NameKey& key) const {
+        //the first sample that is not smaller bounds the block the answer is in
+        const size_t j = lower_bound(samples.begin(), samples.end(), key) - samples.begin();
+        if (j == 0)
+            return 0;
+        const size_t first = (j - 1) * SEARCH_SAMPLE_STRIDE + 1;
+        const size_t last = min(keys.size(), j * SEARCH_SAMPLE_STRIDE);
+        size_t smaller = 0;
+        for (size_t i = first; i < last; i++)
+            smaller += keys[i] < key;
+        return first + smaller;
+    }
+    size_t interpolationLowerBound(const NameKey& key) const {
+        const size_t bucket = key.prefix >> 48;
+        size_t low = bucketStart[bucket], high = bucketStart[bucket + 1];
+        if (low == high || !(keys[low] < key))
+            return low;
+        if (keys[high - 1] < key)
+            return high;
+        //keys[low] < key <= keys[high - 1]: the guess is corrected by steps of 1, 2, 4, ... towards the answer
+        const uint64_t span = keys[high - 1].prefix - keys[low].prefix;
+        size_t guess = low + (span == 0 ? (high - 1 - low) / 2
+            : (size_t)((double)(key.prefix - keys[low].prefix) / (double)span * (high - 1 - low)));
+        guess = min(max(guess, low + 1), high - 1);
+        if (keys[guess] < key) {
+            low = guess;
+            size_t step = 1;
+            while (low + step < high - 1 && keys[low + step] < key)
+                step *= 2;
+            high = min(low + step, high - 1);
+            low += step / 2;
+        }
+        else {
+            high = guess;
+            size_t step = 1;
+            while (high - low > step && !(keys[high - step] < key))
+                step *= 2;
+            low = high - min(step, high - low);
+            high -= step / 2;
+        }
+        //keys[low] < key <= keys[high] and the answer is in (low, high]
+        while (high - low > 1) {
+            size_t middle = low + (high - low) / 2;
+            if (keys[middle] < key)
+                low = middle;
+            else
+                high = middle;
+        }
+        return high;
+    }
+};
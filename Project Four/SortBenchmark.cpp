@@ -0,0 +1,620 @@
+/*
+Non-interactive benchmark of the sorting algorithms.
+Written by Hagverdi Ibrahimli
+
+Usage: sorting_algorithms --bench <contact file> [key=value ...]
+    sizes=1000,10000,100000  numbers of contacts to sort
+    trials=3                 repetitions of every measurement
+    quadraticmax=20000       largest size the O(n^2) sorts are run on
+    threads=1,2,4,...        thread counts of the parallel measurement, by default powers of two up to the core count
+    parallelsize=1000000     contacts sorted by the parallel measurement, 0 skips it
+    order=shuffled           order of the input: shuffled, sorted, reversed, partial (sorted, then 5% of the
+                             contacts swapped with random others), or duplicates (the first 100 contacts of the file
+                             repeated, shuffled)
+    searches=10000           queries of every kind the search measurement makes on every size, 0 skips it
+    scansize=1000000         contacts searched by the column scan measurement, 0 skips it
+    seed=1
+The contacts of the file are extended with generated names until each size is reached and put in the requested order;
+every algorithm sorts a copy of the same input. merge is the in-place MergeSort of the assignment; merge_bottomup,
+merge_natural and merge_inplace are BufferedMergeSort's bottom-up and natural sorts and its bottom-up sort without a
+buffer. intro and intro_block are IntroSort with the three-way and with the block partition. msd_radix,
+multikey_quick and burst are the string sorts, which read the full names char by char.
+The contacts mode sorts the Contact vector comparing the names of the contacts, the keys mode sorts precomputed (key, contact) pairs with the same algorithm and then moves the contacts to their places once.
+The report gives the mean and the fastest time of the trials as CSV, the mean divided by n log2 n, which stays
+about constant for an O(n log n) sort, and the mean number of heap allocations a sort made, which is only counted
+when the program is built with -DSORT_BENCHMARK_COUNT_ALLOCATIONS and is left empty otherwise. heap_bottomup, heap_4ary,
+heap_8ary and heap_index are the HeapSort variants. A second table counts the comparisons the comparison sorts make on
+the keys of the same sizes.
+The parallel measurement sorts parallelsize contacts with the parallel sorts at every thread count and reports the
+speedup over the same sort on the first thread count. In keys mode only the sort of the keys runs in parallel. Every result is checked to be sorted and to hold the contacts of the input.
+The search measurement sorts every size and looks up the full names of random contacts (hit), the same names with a
+changed last name (miss) and the first names of random contacts (firstname) with searchSequential (up to
+quadraticmax), searchBinary and the three ContactSearchIndex layouts. It reports the mean time of a search and the
+number of contacts found, and checks that every search finds what searchSequential or searchBinary finds.
+The column scan measurement searches scansize contacts in ContactColumns for first name prefixes (prefix), full names
+(fullname), and parts of full names (substring) and of cities (city), SCAN_QUERIES random queries of each, with every
+supported kernel at every thread count. Its rows give the bytes of the columns scanned per second; the contacts rows
+search the Contact vector as searchSequential does, on one thread, and are given the same bytes so the speeds compare.
+Every scan is checked to find the rows the contacts scan finds.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+
+#define SCAN_QUERIES 8 //queries of every kind the column scan measurement makes
+
+//allocations counted so far; they are only counted in a build with SORT_BENCHMARK_COUNT_ALLOCATIONS defined, which
+//replaces the global operator new and delete, so the interactive program and the default build keep the usual ones
+atomic<uint64_t> sortBenchmarkAllocations(0);
+
+#ifdef SORT_BENCHMARK_COUNT_ALLOCATIONS
+//not inlined, so GCC does not pair the free with the new expression it releases and warn about a mismatch
+__attribute__((noinline)) void releaseCounted(void* memory) noexcept {
+    free(memory);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    sortBenchmarkAllocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+void* operator new(size_t size) {
+    if (void* memory = operator new(size, nothrow))
+        return memory;
+    throw bad_alloc();
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return operator new(size, nothrow);
+}
+void operator delete(void* memory) noexcept {
+    releaseCounted(memory);
+}
+void operator delete(void* memory, size_t) noexcept {
+    releaseCounted(memory);
+}
+void operator delete(void* memory, const nothrow_t&) noexcept {
+    releaseCounted(memory);
+}
+void operator delete[](void* memory) noexcept {
+    releaseCounted(memory);
+}
+void operator delete[](void* memory, size_t) noexcept {
+    releaseCounted(memory);
+}
+void operator delete[](void* memory, const nothrow_t&) noexcept {
+    releaseCounted(memory);
+}
+#endif
+
+struct SortBenchmarkConfig {
+    string fileName;
+    vector<int> sizes = { 1000, 10000, 100000 };
+    int trials = 3;
+    int quadraticMax = 20000;
+    vector<int> threads;
+    int parallelSize = 1000000;
+    string order = "shuffled";
+    int searches = 10000;
+    int scanSize = 1000000;
+    unsigned seed = 1;
+};
+
+struct ParallelSortEngine {
+    string name;
+    function<void(vector<Contact>&, int)> sortContacts;
+    function<void(vector<ContactKey>&, int)> sortKeys;
+};
+
+struct SortEngine {
+    string name;
+    bool quadratic; //only run up to quadraticMax contacts
+    function<void(vector<Contact>&)> sortContacts;
+    function<void(vector<ContactKey>&)> sortKeys;
+};
+
+//a key whose comparisons are counted; the comparison sorts sort it like any other element through isLess
+struct CountedKey {
+    ContactKey key;
+};
+
+uint64_t countedComparisons = 0;
+
+inline bool isLess(const CountedKey& key1, const CountedKey& key2) {
+    countedComparisons++;
+    return isLess(key1.key, key2.key);
+}
+
+struct CountedSortEngine {
+    string name;
+    bool quadratic;
+    function<void(vector<CountedKey>&)> sort;
+};
+
+struct SearchEngine {
+    string name;
+    bool quadratic;
+    function<vector<Contact>(const string&, const string&)> search;
+};
+
+struct SearchQuery {
+    string firstName;
+    string lastName;
+};
+
+//a kind of column scan: scan runs a query with a kernel on a number of threads, matches says whether a contact matches
+//it as searchSequential would check; the substring scans search for the query's firstName
+struct ColumnScanEngine {
+    string name;
+    size_t bytes; //bytes of the columns one query scans
+    function<vector<uint32_t>(const SearchQuery&, ScanKernel, int)> scan;
+    function<bool(const Contact&, const SearchQuery&)> matches;
+    function<SearchQuery(const Contact&, mt19937&)> makeQuery;
+};
+
+vector<int> parseSortBenchmarkList(const string& value) {
+    vector<int> list;
+    stringstream ss(value);
+    string item;
+    while (getline(ss, item, ','))
+        list.push_back(stoi(item));
+    return list;
+}
+
+bool parseSortBenchmarkArgs(int argc, char* argv[], SortBenchmarkConfig& config) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " --bench <contact file> [sizes=1000,10000] [trials=N] [quadraticmax=N] [threads=1,2,4] [parallelsize=N] [order=shuffled|sorted|reversed|partial|duplicates] [searches=N] [scansize=N] [seed=N]" << endl;
+        return false;
+    }
+    config.fileName = argv[2];
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = (eq == string::npos) ? "" : arg.substr(eq + 1);
+        //stoi and stoul, also in parseSortBenchmarkList, throw on a value that is not a number or does not fit
+        try {
+            if (key == "sizes" && !value.empty())
+                config.sizes = parseSortBenchmarkList(value);
+            else if (key == "trials" && !value.empty())
+                config.trials = stoi(value);
+            else if (key == "quadraticmax" && !value.empty())
+                config.quadraticMax = stoi(value);
+            else if (key == "threads" && !value.empty())
+                config.threads = parseSortBenchmarkList(value);
+            else if (key == "parallelsize" && !value.empty())
+                config.parallelSize = stoi(value);
+            else if (key == "order" && (value == "shuffled" || value == "sorted" || value == "reversed" || value == "partial"
+                || value == "duplicates"))
+                config.order = value;
+            else if (key == "searches" && !value.empty())
+                config.searches = stoi(value);
+            else if (key == "scansize" && !value.empty())
+                config.scanSize = stoi(value);
+            else if (key == "seed" && !value.empty())
+                config.seed = stoul(value);
+            else {
+                cerr << "Invalid benchmark argument: " << arg << endl;
+                return false;
+            }
+        }
+        catch (const invalid_argument&) {
+            cerr << "Invalid benchmark argument: " << arg << endl;
+            return false;
+        }
+        catch (const out_of_range&) {
+            cerr << "Invalid benchmark argument: " << arg << endl;
+            return false;
+        }
+    }
+    if (config.threads.empty())
+        for (int count = 1; count <= (int)max(1u, thread::hardware_concurrency()); count *= 2)
+            config.threads.push_back(count);
+    for (int count : config.threads) {
+        if (count <= 0) {
+            cerr << "Thread counts must be positive." << endl;
+            return false;
+        }
+    }
+    for (int size : config.sizes) {
+        if (size <= 0) {
+            cerr << "Sizes must be positive." << endl;
+            return false;
+        }
+    }
+    return config.trials > 0 && config.quadraticMax >= 0 && config.parallelSize >= 0 && config.searches >= 0 && config.scanSize >= 0;
+}
+
+//The contacts of the file followed by generated variants of them, in the given order
+vector<Contact> makeSortBenchmarkContacts(const vector<Contact>& contacts, int count, const string& order, mt19937& generator) {
+    vector<Contact> result;
+    result.reserve(count);
+    for (int i = 0; (int)result.size() < count; i++) {
+        const Contact& base = contacts[i % contacts.size()];
+        if (order == "duplicates")
+            result.push_back(contacts[i % min<size_t>(contacts.size(), 100)]);
+        else if (i < (int)contacts.size())
+            result.push_back(base);
+        else
+            result.push_back(Contact(base.firstName, base.lastName + to_string(i), base.phoneNumber, base.city));
+    }
+    shuffle(result.begin(), result.end(), generator);
+    if (order == "shuffled" || order == "duplicates")
+        return result;
+    sortByKeys(result, [](vector<ContactKey>& keys) { BufferedMergeSort<ContactKey>().mergeSort(keys); });
+    if (order == "reversed")
+        reverse(result.begin(), result.end());
+    else if (order == "partial") {
+        for (int i = 0; i < count / 20; i++) {
+            size_t from = uniform_int_distribution<size_t>(0, result.size() - 1)(generator);
+            size_t to = uniform_int_distribution<size_t>(0, result.size() - 1)(generator);
+            swap(result[from], result[to]);
+        }
+    }
+    return result;
+}
+
+//Sum of the hashes of all fields of the contacts, which does not depend on their order
+size_t contactsChecksum(const vector<Contact>& contacts) {
+    size_t sum = 0;
+    for (const Contact& contact : contacts)
+        sum += hash<string>()(contact.firstName + '\n' + contact.lastName + '\n' + contact.phoneNumber + '\n' + contact.city);
+    return sum;
+}
+
+//Whether contacts is sorted and holds the contacts of input: its names must be those of sorted, a sorted copy of
+//input, and its fields must have the checksum of input
+bool isSortedPermutation(const vector<Contact>& contacts, const vector<Contact>& sorted, size_t checksum) {
+    if (contacts.size() != sorted.size())
+        return false;
+    for (size_t i = 0; i < contacts.size(); i++)
+        if (compareFullName(contacts[i], sorted[i].firstName, sorted[i].lastName) != 0)
+            return false;
+    return contactsChecksum(contacts) == checksum;
+}
+
+//Runs sort on copies of input trials times and gives the mean and the fastest time and the mean number of allocations;
+//false if a result is not sorted or lost contacts
+bool timeSort(const string& algorithm, const string& mode, const vector<Contact>& input, int trials,
+    const function<void(vector<Contact>&)>& sort, double& meanMs, double& minMs, double& allocations) {
+    vector<Contact> sorted = input;
+    sortByKeys(sorted, [](vector<ContactKey>& keys) { BufferedMergeSort<ContactKey>().mergeSort(keys); });
+    const size_t checksum = contactsChecksum(input);
+    double totalMs = 0;
+    uint64_t totalAllocations = 0;
+    for (int trial = 0; trial < trials; trial++) {
+        vector<Contact> contacts = input;
+        const uint64_t allocationsBefore = sortBenchmarkAllocations.load();
+        auto start = chrono::steady_clock::now();
+        sort(contacts);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        totalAllocations += sortBenchmarkAllocations.load() - allocationsBefore;
+        if (!isSortedPermutation(contacts, sorted, checksum)) {
+            cerr << algorithm << " (" << mode << ") did not sort " << input.size() << " contacts." << endl;
+            return false;
+        }
+        totalMs += ms;
+        minMs = (trial == 0) ? ms : min(minMs, ms);
+    }
+    meanMs = totalMs / trials;
+    allocations = (double)totalAllocations / trials;
+    return true;
+}
+
+//Times sort and prints the row of the main table
+bool benchmarkSort(const string& algorithm, const string& mode, const vector<Contact>& input, int trials,
+    const function<void(vector<Contact>&)>& sort) {
+    double meanMs, minMs, allocations;
+    if (!timeSort(algorithm, mode, input, trials, sort, meanMs, minMs, allocations))
+        return false;
+    const double nLogN = input.size() * max(1.0, log2((double)input.size()));
+    cout << algorithm << "," << mode << "," << input.size() << "," << meanMs << "," << minMs << "," << meanMs * 1e6 / nLogN
+        << ",";
+#ifdef SORT_BENCHMARK_COUNT_ALLOCATIONS
+    cout << allocations;
+#endif
+    cout << endl;
+    return true;
+}
+
+//Times a parallel sort at every thread count, relative to its time on the first thread count
+bool benchmarkParallelSort(const ParallelSortEngine& engine, const vector<Contact>& input, const SortBenchmarkConfig& config) {
+    for (int keys = 0; keys < 2; keys++) {
+        const string mode = keys ? "keys" : "contacts";
+        double firstMs = 0;
+        for (int threadCount : config.threads) {
+            double meanMs, minMs, allocations;
+            bool sorted = keys
+                ? timeSort(engine.name, mode, input, config.trials, [&](vector<Contact>& v) {
+                    sortByKeys(v, [&](vector<ContactKey>& k) { engine.sortKeys(k, threadCount); });
+                }, meanMs, minMs, allocations)
+                : timeSort(engine.name, mode, input, config.trials, [&](vector<Contact>& v) { engine.sortContacts(v, threadCount); },
+                    meanMs, minMs, allocations);
+            if (!sorted)
+                return false;
+            if (firstMs == 0)
+                firstMs = meanMs;
+            cout << engine.name << "," << mode << "," << threadCount << "," << input.size() << "," << meanMs << "," << firstMs / meanMs << endl;
+        }
+    }
+    return true;
+}
+
+//Random queries of the given kind on the sorted contacts
+vector<SearchQuery> makeSearchQueries(const vector<Contact>& contacts, const string& kind, int count, mt19937& generator) {
+    vector<SearchQuery> queries;
+    for (int i = 0; i < count; i++) {
+        const Contact& contact = contacts[uniform_int_distribution<size_t>(0, contacts.size() - 1)(generator)];
+        if (kind == "hit")
+            queries.push_back(SearchQuery{ contact.firstName, contact.lastName });
+        else if (kind == "miss")
+            queries.push_back(SearchQuery{ contact.firstName, contact.lastName + "#" });
+        else
+            queries.push_back(SearchQuery{ contact.firstName, "" });
+    }
+    return queries;
+}
+
+//Whether two searches found the same names; an exact search may find any of several contacts with the name
+bool sameSearchResults(const vector<Contact>& results1, const vector<Contact>& results2) {
+    if (results1.size() != results2.size())
+        return false;
+    for (size_t i = 0; i < results1.size(); i++)
+        if (compareFullName(results1[i], results2[i].firstName, results2[i].lastName) != 0)
+            return false;
+    return true;
+}
+
+//Times every search engine on the queries and prints its row of the search table
+bool benchmarkSearches(const vector<SearchEngine>& engines, const string& kind, const vector<SearchQuery>& queries,
+    size_t size, const SortBenchmarkConfig& config) {
+    //the first engine that runs on this size is the reference, the others are checked against it
+    const SearchEngine* reference = nullptr;
+    for (const SearchEngine& engine : engines) {
+        if (engine.quadratic && (int)size > config.quadraticMax)
+            continue;
+        if (reference == nullptr)
+            reference = &engine;
+        double totalMs = 0;
+        size_t found = 0;
+        for (int trial = 0; trial < config.trials; trial++) {
+            found = 0;
+            auto start = chrono::steady_clock::now();
+            for (const SearchQuery& query : queries)
+                found += engine.search(query.firstName, query.lastName).size();
+            totalMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        if (reference != &engine) {
+            for (const SearchQuery& query : queries) {
+                if (!sameSearchResults(engine.search(query.firstName, query.lastName),
+                    reference->search(query.firstName, query.lastName))) {
+                    cerr << engine.name << " found other contacts than " << reference->name << " for " << query.firstName
+                        << " " << query.lastName << endl;
+                    return false;
+                }
+            }
+        }
+        cout << engine.name << "," << kind << "," << size << "," << totalMs * 1e6 / config.trials / queries.size() << ","
+            << found << endl;
+    }
+    return true;
+}
+
+//Times engine with every kernel and thread count on random queries and prints its rows of the scan table
+bool benchmarkColumnScan(const ColumnScanEngine& engine, const vector<Contact>& input, const SortBenchmarkConfig& config,
+    mt19937& generator) {
+    vector<SearchQuery> queries;
+    for (int i = 0; i < SCAN_QUERIES; i++)
+        queries.push_back(engine.makeQuery(input[uniform_int_distribution<size_t>(0, input.size() - 1)(generator)], generator));
+    const double gigabytes = (double)engine.bytes * queries.size() / 1e9;
+    //the rows the contacts scan finds are the reference
+    vector<vector<uint32_t>> expected(queries.size());
+    double totalMs = 0;
+    for (int trial = 0; trial < config.trials; trial++) {
+        auto start = chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++) {
+            expected[q].clear();
+            for (size_t row = 0; row < input.size(); row++)
+                if (engine.matches(input[row], queries[q]))
+                    expected[q].push_back(row);
+        }
+        totalMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    size_t found = 0;
+    for (const vector<uint32_t>& rows : expected)
+        found += rows.size();
+    double meanMs = totalMs / config.trials;
+    cout << engine.name << ",contacts,1," << input.size() << "," << meanMs << "," << gigabytes / (meanMs / 1000) << "," << found << endl;
+
+    const pair<ScanKernel, string> kernels[] = { { SCAN_SCALAR, "scalar" }, { SCAN_SSE2, "sse2" }, { SCAN_AVX2, "avx2" } };
+    for (const pair<ScanKernel, string>& kernel : kernels) {
+        if (!scanKernelSupported(kernel.first))
+            continue;
+        for (int threadCount : config.threads) {
+            totalMs = 0;
+            for (int trial = 0; trial < config.trials; trial++) {
+                auto start = chrono::steady_clock::now();
+                for (size_t q = 0; q < queries.size(); q++) {
+                    if (engine.scan(queries[q], kernel.first, threadCount) != expected[q]) {
+                        cerr << engine.name << " (" << kernel.second << ") found other rows than the contacts scan for "
+                            << queries[q].firstName << " " << queries[q].lastName << endl;
+                        return false;
+                    }
+                }
+                totalMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            }
+            meanMs = totalMs / config.trials;
+            cout << engine.name << "," << kernel.second << "," << threadCount << "," << input.size() << "," << meanMs << ","
+                << gigabytes / (meanMs / 1000) << "," << found << endl;
+        }
+    }
+    return true;
+}
+
+int runSortBenchmark(int argc, char* argv[]) {
+    SortBenchmarkConfig config;
+    if (!parseSortBenchmarkArgs(argc, argv, config))
+        return 1;
+    PhonebookFile phonebook;
+    if (!phonebook.load(config.fileName, UPPERCASE_NAMES) || phonebook.size() == 0) {
+        cerr << "Error opening file. Please try again." << endl;
+        return 1;
+    }
+    const vector<Contact> contacts = phonebook.contacts<Contact>();
+    mt19937 generator(config.seed);
+
+    const vector<SortEngine> engines = {
+        { "quick", false, [](vector<Contact>& v) { QuickSort<Contact>().quickSort(v); },
+            [](vector<ContactKey>& v) { QuickSort<ContactKey>().quickSort(v); } },
+        { "intro", false, [](vector<Contact>& v) { IntroSort<Contact>().introSort(v); },
+            [](vector<ContactKey>& v) { IntroSort<ContactKey>().introSort(v); } },
+        { "intro_block", false, [](vector<Contact>& v) { IntroSort<Contact>(true).introSort(v); },
+            [](vector<ContactKey>& v) { IntroSort<ContactKey>(true).introSort(v); } },
+        { "merge", true, [](vector<Contact>& v) { MergeSort<Contact>().mergeSort(v); },
+            [](vector<ContactKey>& v) { MergeSort<ContactKey>().mergeSort(v); } },
+        { "merge_bottomup", false, [](vector<Contact>& v) { BufferedMergeSort<Contact>().mergeSort(v); },
+            [](vector<ContactKey>& v) { BufferedMergeSort<ContactKey>().mergeSort(v); } },
+        { "merge_natural", false, [](vector<Contact>& v) { BufferedMergeSort<Contact>().naturalMergeSort(v); },
+            [](vector<ContactKey>& v) { BufferedMergeSort<ContactKey>().naturalMergeSort(v); } },
+        { "merge_inplace", false, [](vector<Contact>& v) { BufferedMergeSort<Contact>(0).mergeSort(v); },
+            [](vector<ContactKey>& v) { BufferedMergeSort<ContactKey>(0).mergeSort(v); } },
+        { "heap", false, [](vector<Contact>& v) { HeapSort<Contact>().heapSort(v); },
+            [](vector<ContactKey>& v) { HeapSort<ContactKey>().heapSort(v); } },
+        { "heap_bottomup", false, [](vector<Contact>& v) { HeapSort<Contact>(HEAP_BOTTOM_UP).heapSort(v); },
+            [](vector<ContactKey>& v) { HeapSort<ContactKey>(HEAP_BOTTOM_UP).heapSort(v); } },
+        { "heap_4ary", false, [](vector<Contact>& v) { HeapSort<Contact>(HEAP_DARY, 4).heapSort(v); },
+            [](vector<ContactKey>& v) { HeapSort<ContactKey>(HEAP_DARY, 4).heapSort(v); } },
+        { "heap_8ary", false, [](vector<Contact>& v) { HeapSort<Contact>(HEAP_DARY, 8).heapSort(v); },
+            [](vector<ContactKey>& v) { HeapSort<ContactKey>(HEAP_DARY, 8).heapSort(v); } },
+        { "heap_index", false, [](vector<Contact>& v) { HeapSort<Contact>(HEAP_INDEX).heapSort(v); },
+            [](vector<ContactKey>& v) { HeapSort<ContactKey>(HEAP_INDEX).heapSort(v); } },
+        { "insertion", true, [](vector<Contact>& v) { InsertionSort<Contact>().insertionSort(v); },
+            [](vector<ContactKey>& v) { InsertionSort<ContactKey>().insertionSort(v); } },
+        { "msd_radix", false, [](vector<Contact>& v) { MSDRadixSort<Contact>().radixSort(v); },
+            [](vector<ContactKey>& v) { MSDRadixSort<ContactKey>().radixSort(v); } },
+        { "multikey_quick", false, [](vector<Contact>& v) { MultikeyQuickSort<Contact>().multikeyQuickSort(v); },
+            [](vector<ContactKey>& v) { MultikeyQuickSort<ContactKey>().multikeyQuickSort(v); } },
+        { "burst", false, [](vector<Contact>& v) { BurstSort<Contact>().burstSort(v); },
+            [](vector<ContactKey>& v) { BurstSort<ContactKey>().burstSort(v); } },
+    };
+
+    cout << "algorithm,mode,size,mean_ms,min_ms,ns_per_nlogn,allocations" << endl;
+    for (int size : config.sizes) {
+        const vector<Contact> input = makeSortBenchmarkContacts(contacts, size, config.order, generator);
+        for (const SortEngine& engine : engines) {
+            if (engine.quadratic && size > config.quadraticMax)
+                continue;
+            if (engine.sortContacts && !benchmarkSort(engine.name, "contacts", input, config.trials, engine.sortContacts))
+                return 1;
+            if (engine.sortKeys && !benchmarkSort(engine.name, "keys", input, config.trials, [&](vector<Contact>& v) {
+                sortByKeys(v, engine.sortKeys);
+            }))
+                return 1;
+        }
+    }
+
+    const vector<CountedSortEngine> countedEngines = {
+        { "quick", false, [](vector<CountedKey>& v) { QuickSort<CountedKey>().quickSort(v); } },
+        { "intro", false, [](vector<CountedKey>& v) { IntroSort<CountedKey>().introSort(v); } },
+        { "merge_bottomup", false, [](vector<CountedKey>& v) { BufferedMergeSort<CountedKey>().mergeSort(v); } },
+        { "heap", false, [](vector<CountedKey>& v) { HeapSort<CountedKey>().heapSort(v); } },
+        { "heap_bottomup", false, [](vector<CountedKey>& v) { HeapSort<CountedKey>(HEAP_BOTTOM_UP).heapSort(v); } },
+        { "heap_4ary", false, [](vector<CountedKey>& v) { HeapSort<CountedKey>(HEAP_DARY, 4).heapSort(v); } },
+        { "heap_8ary", false, [](vector<CountedKey>& v) { HeapSort<CountedKey>(HEAP_DARY, 8).heapSort(v); } },
+        { "heap_index", false, [](vector<CountedKey>& v) { HeapSort<CountedKey>(HEAP_INDEX).heapSort(v); } },
+        { "insertion", true, [](vector<CountedKey>& v) { InsertionSort<CountedKey>().insertionSort(v); } },
+    };
+    cout << endl << "algorithm,size,comparisons,comparisons_per_nlogn" << endl;
+    for (int size : config.sizes) {
+        const vector<Contact> input = makeSortBenchmarkContacts(contacts, size, config.order, generator);
+        vector<CountedKey> keys;
+        for (const ContactKey& key : makeContactKeys(input))
+            keys.push_back(CountedKey{ key });
+        const double nLogN = size * max(1.0, log2((double)size));
+        for (const CountedSortEngine& engine : countedEngines) {
+            if (engine.quadratic && size > config.quadraticMax)
+                continue;
+            vector<CountedKey> sorted = keys;
+            countedComparisons = 0;
+            engine.sort(sorted);
+            cout << engine.name << "," << size << "," << countedComparisons << "," << countedComparisons / nLogN << endl;
+        }
+    }
+
+    if (config.searches > 0) {
+        cout << endl << "algorithm,queries,size,ns_per_search,found" << endl;
+        for (int size : config.sizes) {
+            vector<Contact> sorted = makeSortBenchmarkContacts(contacts, size, config.order, generator);
+            sortByKeys(sorted, [](vector<ContactKey>& keys) { BufferedMergeSort<ContactKey>().mergeSort(keys); });
+            const ContactSearchIndex eytzinger(sorted, SEARCH_EYTZINGER);
+            const ContactSearchIndex sampled(sorted, SEARCH_SAMPLED);
+            const ContactSearchIndex interpolation(sorted, SEARCH_INTERPOLATION);
+            const vector<SearchEngine> searchEngines = {
+                { "sequential", true, [&](const string& f, const string& l) { return searchSequential(sorted, f, l); } },
+                { "binary", false, [&](const string& f, const string& l) { return searchBinary(sorted, f, l); } },
+                { "index_eytzinger", false, [&](const string& f, const string& l) { return eytzinger.search(f, l); } },
+                { "index_sampled", false, [&](const string& f, const string& l) { return sampled.search(f, l); } },
+                { "index_interpolation", false, [&](const string& f, const string& l) { return interpolation.search(f, l); } },
+            };
+            for (const char* kind : { "hit", "miss", "firstname" })
+                if (!benchmarkSearches(searchEngines, kind, makeSearchQueries(sorted, kind, config.searches, generator), size, config))
+                    return 1;
+        }
+    }
+
+    if (config.scanSize > 0) {
+        const vector<Contact> input = makeSortBenchmarkContacts(contacts, config.scanSize, "shuffled", generator);
+        const ContactColumns columns(input);
+        //a part of at most length chars of text, from a random place
+        auto randomPart = [](const string& text, size_t length, mt19937& generator) {
+            return text.substr(uniform_int_distribution<size_t>(0, text.size() - min(text.size(), length))(generator), length);
+        };
+        const vector<ColumnScanEngine> scanEngines = {
+            { "prefix", columns.prefixColumnBytes(),
+                [&](const SearchQuery& q, ScanKernel kernel, int t) { return columns.firstNamePrefixRows(q.firstName, kernel, t); },
+                [](const Contact& contact, const SearchQuery& q) {
+                    return contact.firstName.compare(0, q.firstName.size(), q.firstName) == 0;
+                },
+                [](const Contact& contact, mt19937&) { return SearchQuery{ contact.firstName.substr(0, 2), "" }; } },
+            { "fullname", columns.prefixColumnBytes(),
+                [&](const SearchQuery& q, ScanKernel kernel, int t) { return columns.fullNameRows(q.firstName, q.lastName, kernel, t); },
+                [](const Contact& contact, const SearchQuery& q) { return compareFullName(contact, q.firstName, q.lastName) == 0; },
+                [](const Contact& contact, mt19937&) { return SearchQuery{ contact.firstName, contact.lastName }; } },
+            { "substring", columns.textBytes(SCAN_FULL_NAME),
+                [&](const SearchQuery& q, ScanKernel kernel, int t) { return columns.substringRows(SCAN_FULL_NAME, q.firstName, kernel, t); },
+                [](const Contact& contact, const SearchQuery& q) { return contact.getFullName().find(q.firstName) != string::npos; },
+                [&](const Contact& contact, mt19937& g) { return SearchQuery{ randomPart(contact.lastName, 3, g), "" }; } },
+            { "city", columns.textBytes(SCAN_CITY),
+                [&](const SearchQuery& q, ScanKernel kernel, int t) { return columns.substringRows(SCAN_CITY, q.firstName, kernel, t); },
+                [](const Contact& contact, const SearchQuery& q) { return contact.city.find(q.firstName) != string::npos; },
+                [&](const Contact& contact, mt19937& g) { return SearchQuery{ randomPart(contact.city, 3, g), "" }; } },
+        };
+        cout << endl << "search,kernel,threads,size,mean_ms,gb_per_s,matches" << endl;
+        for (const ColumnScanEngine& engine : scanEngines)
+            if (!benchmarkColumnScan(engine, input, config, generator))
+                return 1;
+    }
+
+    if (config.parallelSize > 0) {
+        const vector<ParallelSortEngine> parallelEngines = {
+            { "parallel_quick", [](vector<Contact>& v, int t) { ParallelQuickSort<Contact>(t).quickSort(v); },
+                [](vector<ContactKey>& v, int t) { ParallelQuickSort<ContactKey>(t).quickSort(v); } },
+            { "parallel_merge", [](vector<Contact>& v, int t) { ParallelMergeSort<Contact>(t).mergeSort(v); },
+                [](vector<ContactKey>& v, int t) { ParallelMergeSort<ContactKey>(t).mergeSort(v); } },
+            { "sample", [](vector<Contact>& v, int t) { ParallelSampleSort<Contact>(t).sampleSort(v); },
+                [](vector<ContactKey>& v, int t) { ParallelSampleSort<ContactKey>(t).sampleSort(v); } },
+        };
+        const vector<Contact> input = makeSortBenchmarkContacts(contacts, config.parallelSize, config.order, generator);
+        cout << endl << "algorithm,mode,threads,size,mean_ms,speedup" << endl;
+        for (const ParallelSortEngine& engine : parallelEngines)
+            if (!benchmarkParallelSort(engine, input, config))
+                return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+Precomputed sort keys of the contacts.
+Written by Hagverdi Ibrahimli
+
+Contacts are ordered by full name, "FIRSTNAME LASTNAME", compared char by char as isSmaller does. Comparing two contacts
+reads the strings of both names, in other parts of memory, at every comparison.
+A ContactKey is computed once per contact instead: the first 8 bytes of the full name packed into an integer that orders
+like the name, and a pointer to the contact for the rare comparisons whose prefixes are equal. The sort templates sort
+the keys and the contacts are then moved to their places once.
+*/
+
+#include <cstdint>
+
+struct ContactKey {
+    uint64_t prefix; //first 8 bytes of the full name, big-endian, zero padded
+    const Contact* contact;
+};
+
+//char i of firstName + " " + lastName
+inline char fullNameAt(const string& firstName, const string& lastName, size_t i) {
+    if (i < firstName.size())
+        return firstName[i];
+    return i == firstName.size() ? ' ' : lastName[i - firstName.size() - 1];
+}
+
+//compares the full name of the contact with firstName + " " + lastName as isSmaller would, without building either string:
+//negative if the contact comes first, 0 if the names are equal, positive if it comes after. The first from chars are known to be equal
+int compareFullName(const Contact& contact, const string& firstName, const string& lastName, size_t from = 0) {
+    const size_t leftSize = contact.firstName.size() + 1 + contact.lastName.size();
+    const size_t rightSize = firstName.size() + 1 + lastName.size();
+    for (size_t i = from; i < leftSize && i < rightSize; i++) {
+        char l = fullNameAt(contact.firstName, contact.lastName, i);
+        char r = fullNameAt(firstName, lastName, i);
+        if (l != r)
+            return l < r ? -1 : 1;
+    }
+    return leftSize < rightSize ? -1 : (leftSize > rightSize ? 1 : 0);
+}
+
+ContactKey makeContactKey(const Contact& contact) {
+    uint64_t prefix = 0;
+    int bytes = 0;
+    auto append = [&](const string& part) {
+        for (size_t i = 0; i < part.size() && bytes < 8; i++, bytes++)
+            prefix = (prefix << 8) | (uint8_t)(part[i] ^ 0x80); //flipping the sign bit makes the unsigned order match char's
+    };
+    append(contact.firstName);
+    if (bytes < 8) {
+        prefix = (prefix << 8) | (uint8_t)(' ' ^ 0x80);
+        bytes++;
+    }
+    append(contact.lastName);
+    if (bytes < 8)
+        prefix <<= 8 * (8 - bytes);
+    return ContactKey{ prefix, &contact };
+}
+
+vector<ContactKey> makeContactKeys(const vector<Contact>& contacts) {
+    vector<ContactKey> keys;
+    keys.reserve(contacts.size());
+    for (const Contact& contact : contacts)
+        keys.push_back(makeContactKey(contact));
+    return keys;
+}
+
+//order of the sort templates, the full names of two contacts, compared without building them
+inline bool isLess(const Contact& contact1, const Contact& contact2) {
+    return compareFullName(contact1, contact2.firstName, contact2.lastName) < 0;
+}
+//a shorter name pads its prefix with zeros, which can equal a real char, so equal prefixes fall back to the full names
+inline bool isLess(const ContactKey& key1, const ContactKey& key2) {
+    if (key1.prefix != key2.prefix)
+        return key1.prefix < key2.prefix;
+    const Contact& contact1 = *key1.contact;
+    const Contact& contact2 = *key2.contact;
+    const size_t known = min<size_t>(8, min(contact1.firstName.size() + contact1.lastName.size(), contact2.firstName.size() + contact2.lastName.size()) + 1);
+    return compareFullName(contact1, contact2.firstName, contact2.lastName, known) < 0;
+}
+
+//sorts the contacts by full name through their keys; sortKeys sorts a vector<ContactKey> with one of the sort templates,
+//e.g. [](vector<ContactKey>& keys) { QuickSort<ContactKey>().quickSort(keys); }
+template <class SortKeys>
+void sortByKeys(vector<Contact>& contacts, SortKeys sortKeys) {
+    vector<ContactKey> keys = makeContactKeys(contacts);
+    sortKeys(keys);
+    vector<Contact> sorted;
+    sorted.reserve(contacts.size());
+    for (const ContactKey& key : keys)
+        sorted.push_back(move(contacts[key.contact - contacts.data()]));
+    contacts.swap(sorted);
+}
@@ -0,0 +1,200 @@
+/*
+Implementation of the string sorts.
+Written by Hagverdi Ibrahimli
+
+The comparison sorts compare whole names, so the chars shared by two names are read again in every comparison between
+them. These sorts look at the full name one char at a time instead, and every char of a name is read O(1) times per level:
+    MSDRadixSort        distributes the elements by their char at depth d into 257 buckets and sorts every bucket at d + 1;
+                        small buckets are insertion sorted starting from d
+    MultikeyQuickSort   three-way partitions around the char at depth d of a pivot (Bentley and Sedgewick); the equal
+                        part continues at d + 1 and the smaller and larger parts at d
+    BurstSort           inserts the elements into a trie whose leaves are buckets; a bucket that grows past BURST_LIMIT
+                        bursts into a new trie node. The buckets are then sorted with MultikeyQuickSort in trie order,
+                        each small enough to stay in cache while it is sorted
+All three order the full names as isSmaller does and work on Contact as well as on ContactKey, whose prefix gives the
+first 8 chars without touching the contact. None of them is stable.
+*/
+
+#include <cstdint>
+#include <memory>
+
+#define STRING_SORT_CUTOFF 32 //ranges up to this size are insertion sorted
+#define NAME_ALPHABET 257 //bucket 0 ends the name, buckets 1 to 256 are the chars in char order
+#define BURST_LIMIT 4096 //elements a bucket of the burst trie holds before it bursts
+
+inline size_t fullNameLength(const Contact& contact) {
+    return contact.firstName.size() + 1 + contact.lastName.size();
+}
+
+//bucket of char d of the full name: 0 past its end, otherwise 1 + the char with its sign bit flipped
+inline int nameCharAt(const Contact& contact, size_t d) {
+    if (d >= fullNameLength(contact))
+        return 0;
+    return (uint8_t)(fullNameAt(contact.firstName, contact.lastName, d) ^ 0x80) + 1;
+}
+inline int nameCharAt(const ContactKey& key, size_t d) {
+    if (d < 8) {
+        const int byte = (key.prefix >> (56 - 8 * d)) & 0xFF;
+        //a zero byte is either padding or a char that flips to zero, only the length tells them apart
+        if (byte != 0)
+            return byte + 1;
+        return d < fullNameLength(*key.contact) ? 1 : 0;
+    }
+    return nameCharAt(*key.contact, d);
+}
+
+//isLess for two elements whose first d chars are known to be equal
+inline bool isLessFrom(const Contact& contact1, const Contact& contact2, size_t d) {
+    return compareFullName(contact1, contact2.firstName, contact2.lastName, d) < 0;
+}
+inline bool isLessFrom(const ContactKey& key1, const ContactKey& key2, size_t d) {
+    if (d < 8 && key1.prefix != key2.prefix)
+        return key1.prefix < key2.prefix;
+    return compareFullName(*key1.contact, key2.contact->firstName, key2.contact->lastName, d) < 0;
+}
+
+//insertion sort of [first, last) whose elements share their first d chars
+template<class T>
+void insertionSortFrom(vector<T>& myVector, size_t first, size_t last, size_t d) {
+    for (size_t i = first + 1; i < last; i++) {
+        T temp = move(myVector[i]);
+        size_t j = i;
+        for (; j > first && isLessFrom(temp, myVector[j - 1], d); j--)
+            myVector[j] = move(myVector[j - 1]);
+        myVector[j] = move(temp);
+    }
+}
+
+template<class T>
+class MSDRadixSort {
+public:
+    void radixSort(vector<T>& myVector) {
+        buffer.resize(myVector.size());
+        chars.resize(myVector.size());
+        radixSort(myVector, 0, myVector.size(), 0);
+        buffer.clear();
+    }
+private:
+    vector<T> buffer;
+    vector<uint16_t> chars; //char at the current depth of every element of the range being distributed
+
+    //sorts [first, last), whose elements share their first d chars
+    void radixSort(vector<T>& myVector, size_t first, size_t last, size_t d) {
+        if (last - first <= STRING_SORT_CUTOFF) {
+            insertionSortFrom(myVector, first, last, d);
+            return;
+        }
+        size_t count[NAME_ALPHABET + 1] = {};
+        for (size_t i = first; i < last; i++) {
+            chars[i] = nameCharAt(myVector[i], d);
+            count[chars[i] + 1]++;
+        }
+        for (int c = 0; c < NAME_ALPHABET; c++)
+            count[c + 1] += count[c];
+        //count[c] is now the start of bucket c, and is advanced while the bucket is filled
+        for (size_t i = first; i < last; i++)
+            buffer[first + count[chars[i]]++] = move(myVector[i]);
+        for (size_t i = first; i < last; i++)
+            myVector[i] = move(buffer[i]);
+        //bucket c now ends at count[c]; the names of bucket 0 have ended and are equal
+        for (int c = 1; c < NAME_ALPHABET; c++)
+            if (count[c] - count[c - 1] > 1)
+                radixSort(myVector, first + count[c - 1], first + count[c], d + 1);
+    }
+};
+
+template<class T>
+class MultikeyQuickSort {
+public:
+    void multikeyQuickSort(vector<T>& myVector) {
+        multikeyQuickSort(myVector, 0, myVector.size(), 0);
+    }
+    //sorts [first, last), whose elements share their first d chars
+    void multikeyQuickSort(vector<T>& myVector, size_t first, size_t last, size_t d) {
+        while (last - first > STRING_SORT_CUTOFF) {
+            const int pivot = medianChar(myVector, first, last, d);
+            //[first, less) before the pivot char, [less, i) equal to it, [greater, last) after it
+            size_t less = first, i = first, greater = last;
+            while (i < greater) {
+                const int c = nameCharAt(myVector[i], d);
+                if (c < pivot)
+                    swap(myVector[less++], myVector[i++]);
+                else if (c > pivot)
+                    swap(myVector[i], myVector[--greater]);
+                else
+                    i++;
+            }
+            multikeyQuickSort(myVector, first, less, d);
+            multikeyQuickSort(myVector, greater, last, d);
+            //the equal part continues with the next char, unless its names have ended
+            if (pivot == 0)
+                return;
+            first = less;
+            last = greater;
+            d++;
+        }
+        insertionSortFrom(myVector, first, last, d);
+    }
+private:
+    static int medianChar(const vector<T>& myVector, size_t first, size_t last, size_t d) {
+        const int a = nameCharAt(myVector[first], d);
+        const int b = nameCharAt(myVector[first + (last - first) / 2], d);
+        const int c = nameCharAt(myVector[last - 1], d);
+        return max(min(a, b), min(max(a, b), c));
+    }
+};
+
+template<class T>
+class BurstSort {
+public:
+    void burstSort(vector<T>& myVector) {
+        BurstNode root;
+        for (T& element : myVector)
+            insert(root, move(element));
+        size_t out = 0;
+        collect(root, 0, myVector, out);
+    }
+private:
+    struct BurstNode {
+        vector<T> buckets[NAME_ALPHABET]; //elements whose char at this node's depth is c and that have no child node yet
+        unique_ptr<BurstNode> children[NAME_ALPHABET];
+    };
+
+    static void insert(BurstNode& root, T&& element) {
+        BurstNode* node = &root;
+        size_t d = 0;
+        int c = nameCharAt(element, d);
+        while (node->children[c]) {
+            node = node->children[c].get();
+            c = nameCharAt(element, ++d);
+        }
+        node->buckets[c].push_back(move(element));
+        //the names of bucket 0 have ended and are equal, so it is never burst
+        if (c != 0 && node->buckets[c].size() > BURST_LIMIT)
+            burst(*node, c, d);
+    }
+    //replaces bucket c of the node at depth d by a child node that distributes its elements by their char at d + 1
+    static void burst(BurstNode& node, int c, size_t d) {
+        node.children[c].reset(new BurstNode());
+        BurstNode& child = *node.children[c];
+        for (T& element : node.buckets[c])
+            child.buckets[nameCharAt(element, d + 1)].push_back(move(element));
+        vector<T>().swap(node.buckets[c]);
+        //a bucket of the child can be as large as the burst one, so it is burst on its next insert if it is still too large
+    }
+    //moves the elements under the node at depth d to myVector from out on, sorting each bucket
+    static void collect(BurstNode& node, size_t d, vector<T>& myVector, size_t& out) {
+        for (int c = 0; c < NAME_ALPHABET; c++) {
+            vector<T>& bucket = node.buckets[c];
+            if (!bucket.empty()) {
+                if (c != 0)
+                    MultikeyQuickSort<T>().multikeyQuickSort(bucket, 0, bucket.size(), d + 1);
+                for (T& element : bucket)
+                    myVector[out++] = move(element);
+                vector<T>().swap(bucket);
+            }
+            if (node.children[c])
+                collect(*node.children[c], d + 1, myVector, out);
+        }
+    }
+};
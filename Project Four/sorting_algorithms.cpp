@@ -11,6 +11,7 @@ Purpose of the program: to sort the contacts in the address book and search for
 #include <sstream>
 #include <chrono>
 using namespace std;
+#include "../Common/PhonebookLoader.cpp"
 
 //contact struct
 struct Contact {
@@ -21,11 +22,16 @@ struct Contact {
     Contact() {}; //default constructor
 
     Contact(string _firstName, string _lastName, string _phoneNum, string _city)
-        : firstName(_firstName), lastName(_lastName), phoneNumber(_phoneNum), city(_city) {};
+        : firstName(move(_firstName)), lastName(move(_lastName)), phoneNumber(move(_phoneNum)), city(move(_city)) {};
 
     Contact(const Contact& other)
         : firstName(other.firstName), lastName(other.lastName),
         phoneNumber(other.phoneNumber), city(other.city) {}
+
+    //moving takes over the strings of other instead of copying them, so the sorts move contacts without allocating
+    Contact(Contact&& other) noexcept
+        : firstName(move(other.firstName)), lastName(move(other.lastName)),
+        phoneNumber(move(other.phoneNumber)), city(move(other.city)) {}
   
     Contact& operator=(const Contact& other) {
         if (this != &other) {
@@ -36,6 +42,16 @@ struct Contact {
         }
         return *this;
     }
+
+    Contact& operator=(Contact&& other) noexcept {
+        if (this != &other) {
+            firstName = move(other.firstName);
+            lastName = move(other.lastName);
+            phoneNumber = move(other.phoneNumber);
+            city = move(other.city);
+        }
+        return *this;
+    }
     string getFullName() const {
 		return firstName + " " + lastName;
 	}
@@ -72,12 +88,15 @@ void toUpperCase(string& my_string) {
     }
 }
 
-void swap(Contact &contact1, Contact &contact2) {
-    Contact temp = contact1;
-    contact1 = contact2;
-    contact2 = temp;
+void swap(Contact &contact1, Contact &contact2) noexcept {
+    contact1.firstName.swap(contact2.firstName);
+    contact1.lastName.swap(contact2.lastName);
+    contact1.phoneNumber.swap(contact2.phoneNumber);
+    contact1.city.swap(contact2.city);
 }
 
+#include "SortKeys.cpp"
+
 template<class T>
 class InsertionSort {
 public:
@@ -88,13 +107,13 @@ public:
 
     void insertionSort(vector<T>& myVector, int left, int right) {
         for (int i = left + 1; i <= right; i++) {
-            T temp = myVector[i];
+            T temp = move(myVector[i]);
             int j = i - 1;
-            while (j >= left && isSmaller(temp.getFullName(), myVector[j].getFullName())) {
-                myVector[j + 1] = myVector[j];
+            while (j >= left && isLess(temp, myVector[j])) {
+                myVector[j + 1] = move(myVector[j]);
                 j--;
             }
-            myVector[j + 1] = temp;
+            myVector[j + 1] = move(temp);
         }
     }
 };
@@ -105,82 +124,211 @@ public:
     void quickSort(vector<T>& myVector) {
         quickSort(myVector, 0, myVector.size() - 1);
     }
+
+    void quickSort(vector<T>& myVector, int left, int right) {
+        if (left + 10 <= right) {
+            int i, j;
+            partition(myVector, left, right, i, j);
+            quickSort(myVector, left, j);
+            quickSort(myVector, i, right);
+        }
+        else {
+            InsertionSort<T>().insertionSort(myVector, left, right);
+        }
+    }
+    //partitions [left, right], which must hold more than 10 elements, around the median of three; the pivot ends at i,
+    //with no element after it in [left, i - 1] and none before it in [i + 1, right]. j is i or i - 1
+    void partition(vector<T>& myVector, int left, int right, int& i, int& j) {
+        //the pivot stays at right - 1 until the last swap, as i and j stop before it
+        const T& pivot = medianOfThree(myVector, left, right);
+        //begin partitioning
+        i = left;
+        j = right - 1;
+        while (true) {
+            while (isLess(myVector[++i], pivot)) {}
+            while (isLess(pivot, myVector[--j])) {}
+            if (i < j) {
+                swap(myVector[i], myVector[j]);
+            }
+            else {
+                break;
+            }
+        }
+        swap(myVector[i], myVector[right - 1]);
+    }
 private:
-    Contact medianOfThree(vector<T>& myVector, int left, int right) {
+    const T& medianOfThree(vector<T>& myVector, int left, int right) {
         int middle = (left + right) / 2;
-        if (isSmaller(myVector[middle].getFullName(), myVector[left].getFullName())) {
+        if (isLess(myVector[middle], myVector[left])) {
             swap(myVector[left], myVector[middle]);
         }
-        if (isSmaller(myVector[right].getFullName(), myVector[left].getFullName())) {
+        if (isLess(myVector[right], myVector[left])) {
             swap(myVector[left], myVector[right]);
         }
-        if (isSmaller(myVector[right].getFullName(), myVector[middle].getFullName())) {
+        if (isLess(myVector[right], myVector[middle])) {
             swap(myVector[middle], myVector[right]);
         }
         swap(myVector[middle], myVector[right - 1]);
         return myVector[right - 1];
     }
+};
 
-    void quickSort(vector<T>& myVector, int left, int right) {
-        if (left + 10 <= right) {
-            T pivot = medianOfThree(myVector, left, right);
-            //begin partitioning
-            int i = left;
-            int j = right - 1;
-            while (true) {
-                while (isSmaller(myVector[++i].getFullName(), pivot.getFullName())) {}
-                while (isSmaller(pivot.getFullName(), myVector[--j].getFullName())) {}
-                if (i < j) {
-                    swap(myVector[i], myVector[j]);
-                }
-                else {
-                    break;
-                }
-            }
-            swap(myVector[i], myVector[right - 1]);
-            quickSort(myVector, left, j);
-            quickSort(myVector, i, right);
-        }
-        else {
-            InsertionSort<T>().insertionSort(myVector, left, right);
-        }
-    }
+//heap layouts of HeapSort; every one but HEAP_INDEX sorts in place
+enum HeapSortVariant {
+    HEAP_TEXTBOOK, //binary heap, sift down with two comparisons per level
+    HEAP_BOTTOM_UP, //binary heap, sift down to a leaf along the larger children and back up to the place of the element
+    HEAP_DARY, //heap with arity children per node, which are adjacent in memory, so a level costs one or two cache lines
+    HEAP_INDEX, //bottom-up binary heap of 32-bit positions, the elements are moved once when the order is known
 };
 
 template<class T>
 class HeapSort {
 public:
+    explicit HeapSort(HeapSortVariant variant = HEAP_TEXTBOOK, int arity = 4) : variant(variant), arity(max(2, arity)) {}
+
     void heapSort(vector<T>& myVector) {
-        for (int i = myVector.size() / 2 - 1; i >= 0; i--) {
-            percDown(myVector, i, myVector.size());
+        heapSort(myVector, 0, myVector.size() - 1);
+    }
+
+    //sorts [left, right]; the heap is built on the range, with its root at left
+    void heapSort(vector<T>& myVector, int left, int right) {
+        int n = right - left + 1;
+        if (variant == HEAP_INDEX) {
+            indexHeapSort(myVector, left, n);
+            return;
+        }
+        for (int i = lastParent(n); i >= 0; i--) {
+            siftDown(myVector, left, i, n);
         }
-        for (int j = myVector.size() - 1; j > 0; j--) {
-            swap(myVector[0], myVector[j]);
-            percDown(myVector, 0, j);
+        for (int j = n - 1; j > 0; j--) {
+            swap(myVector[left], myVector[left + j]);
+            siftDown(myVector, left, 0, j);
         }
     }
 private:
+    HeapSortVariant variant;
+    int arity;
+
     int leftChild(int i) {
         return 2 * i + 1;
     }
-    void percDown(vector<T>& myVector, int i, int n) {
+    int lastParent(int n) {
+        return variant == HEAP_DARY ? (n >= 2 ? (n - 2) / arity : -1) : n / 2 - 1;
+    }
+    void siftDown(vector<T>& myVector, int left, int i, int n) {
+        if (variant == HEAP_BOTTOM_UP)
+            bottomUpSiftDown(myVector, left, i, n);
+        else if (variant == HEAP_DARY)
+            daryPercDown(myVector, left, i, n);
+        else
+            percDown(myVector, left, i, n);
+    }
+    //i and n are relative to the root at left
+    void percDown(vector<T>& myVector, int left, int i, int n) {
         int child;
         T temp;
-        for (temp = myVector[i]; leftChild(i) < n; i = child) {
+        for (temp = move(myVector[left + i]); leftChild(i) < n; i = child) {
             child = 2 * i + 1;
-            if (child != n - 1 && isSmaller(myVector[child].getFullName(), myVector[child + 1].getFullName())) {
+            if (child != n - 1 && isLess(myVector[left + child], myVector[left + child + 1])) {
                 child++;
             }
-            if (isSmaller(temp.getFullName(), myVector[child].getFullName())) {
-                myVector[i] = myVector[child];
+            if (isLess(temp, myVector[left + child])) {
+                myVector[left + i] = move(myVector[left + child]);
             }
             else {
                 break;
             }
         }
-        myVector[i] = temp;
+        myVector[left + i] = move(temp);
+    }
+    //the element at i usually belongs near a leaf, so the hole it leaves is moved down to a leaf along the larger
+    //children with one comparison per level, and the element rises from there to its place, usually within a level or two
+    void bottomUpSiftDown(vector<T>& myVector, int left, int i, int n) {
+        T temp = move(myVector[left + i]);
+        int hole = i;
+        while (leftChild(hole) + 1 < n) {
+            int child = leftChild(hole);
+            if (isLess(myVector[left + child], myVector[left + child + 1])) {
+                child++;
+            }
+            myVector[left + hole] = move(myVector[left + child]);
+            hole = child;
+        }
+        if (leftChild(hole) < n) {
+            myVector[left + hole] = move(myVector[left + leftChild(hole)]);
+            hole = leftChild(hole);
+        }
+        while (hole > i && isLess(myVector[left + (hole - 1) / 2], temp)) {
+            myVector[left + hole] = move(myVector[left + (hole - 1) / 2]);
+            hole = (hole - 1) / 2;
+        }
+        myVector[left + hole] = move(temp);
+    }
+    //the children of i are arity * i + 1 to arity * i + arity
+    void daryPercDown(vector<T>& myVector, int left, int i, int n) {
+        T temp = move(myVector[left + i]);
+        while (arity * i + 1 < n) {
+            int first = arity * i + 1;
+            int last = min(first + arity, n);
+            int child = first;
+            for (int c = first + 1; c < last; c++) {
+                if (isLess(myVector[left + child], myVector[left + c])) {
+                    child = c;
+                }
+            }
+            if (!isLess(temp, myVector[left + child])) {
+                break;
+            }
+            myVector[left + i] = move(myVector[left + child]);
+            i = child;
+        }
+        myVector[left + i] = move(temp);
+    }
+    //bottom-up heap sort of the positions of [left, left + n), compared through the elements; only the 4-byte positions
+    //move while the heap is sorted
+    void indexHeapSort(vector<T>& myVector, int left, int n) {
+        vector<uint32_t> heap(max(n, 0));
+        for (int i = 0; i < n; i++) {
+            heap[i] = left + i;
+        }
+        auto before = [&](uint32_t a, uint32_t b) { return isLess(myVector[a], myVector[b]); };
+        auto sift = [&](int i, int size) {
+            uint32_t temp = heap[i];
+            int hole = i;
+            while (leftChild(hole) + 1 < size) {
+                int child = leftChild(hole);
+                if (before(heap[child], heap[child + 1])) {
+                    child++;
+                }
+                heap[hole] = heap[child];
+                hole = child;
+            }
+            if (leftChild(hole) < size) {
+                heap[hole] = heap[leftChild(hole)];
+                hole = leftChild(hole);
+            }
+            while (hole > i && before(heap[(hole - 1) / 2], temp)) {
+                heap[hole] = heap[(hole - 1) / 2];
+                hole = (hole - 1) / 2;
+            }
+            heap[hole] = temp;
+        };
+        for (int i = n / 2 - 1; i >= 0; i--) {
+            sift(i, n);
+        }
+        for (int j = n - 1; j > 0; j--) {
+            swap(heap[0], heap[j]);
+            sift(0, j);
+        }
+        vector<T> sorted;
+        sorted.reserve(max(n, 0));
+        for (int i = 0; i < n; i++) {
+            sorted.push_back(move(myVector[heap[i]]));
+        }
+        for (int i = 0; i < n; i++) {
+            myVector[left + i] = move(sorted[i]);
+        }
     }
-   
 };
 
 template<class T>
@@ -195,15 +343,15 @@ private:
         int j = mid + 1;
 
         while (i <= mid && j <= right) {
-            if (isSmaller(myVector[i].getFullName(), myVector[j].getFullName())) {
+            if (isLess(myVector[i], myVector[j])) {
                 i++;
             }
             else {
-                T temp = myVector[j];
+                T temp = move(myVector[j]);
                 for (int k = j; k > i; k--) {
-                    myVector[k] = myVector[k - 1];
+                    myVector[k] = move(myVector[k - 1]);
                 }
-                myVector[i] = temp;
+                myVector[i] = move(temp);
                 i++;
                 mid++;
                 j++;
@@ -222,21 +370,25 @@ private:
     
 };
 
+#include "MergeSorts.cpp"
+#include "IntroSort.cpp"
+#include "ParallelSorts.cpp"
+#include "StringSorts.cpp"
+
 vector<Contact> searchSequential(const vector<Contact>& contacts, const string& firstName, const string& lastName) {
 	vector<Contact> results;
     if (lastName.empty()) {
         //search by first input and return all matches
         for (int i = 0; i < contacts.size(); i++) {
-            if (contacts[i].firstName.find(firstName) == 0) {
+            if (contacts[i].firstName.compare(0, firstName.size(), firstName) == 0) {
 				results.push_back(contacts[i]);
 			}
 		}
     }
     else {
         //user provided both first and last name, find if there is a match
-        string fullName = firstName + " " + lastName;
         for (int i = 0; i < contacts.size(); i++) {
-            if (contacts[i].getFullName() == fullName) {
+            if (compareFullName(contacts[i], firstName, lastName) == 0) {
                 results.push_back(contacts[i]);
                 break;
             }
@@ -285,14 +437,14 @@ vector<Contact> searchBinary(const vector<Contact>& contacts, const string& firs
 		//user provided both first and last name, find if there is a match
 		int left = 0;
 		int right = contacts.size() - 1;
-        string fullName = firstName + " " + lastName;
         while (left <= right) {
 			int middle = (left + right) / 2;
-            if (contacts[middle].getFullName() == fullName) {
+            const int order = compareFullName(contacts[middle], firstName, lastName);
+            if (order == 0) {
 				results.push_back(contacts[middle]);
 				break;
 			}
-            else if (isSmaller(contacts[middle].getFullName(), fullName)) {
+            else if (order < 0) {
 				left = middle + 1;
 			}
             else {
@@ -309,32 +461,17 @@ void run() {
     cout << "Enter the contact file name: ";
     getline(cin, fileName);
 
-    ifstream input_file(fileName);
-    if (!input_file.is_open()) {
+    //read the file once with the shared loader, first and last names are upper-cased
+    PhonebookFile phonebook;
+    if (!phonebook.load(fileName, UPPERCASE_NAMES)) {
         cerr << "Error opening file. Please try again." << endl;
         return;
     }
     //create the vectors for each sorting algorithm
-    vector<Contact> contactsQuickSort;
-    vector<Contact> contactsMergeSort;
-    vector<Contact> contactsInsertionSort;
-    vector<Contact> contactsHeapSort;
-
-    string fname, lname, city, phoneNum;
-    while (input_file) {
-        input_file >> fname >> lname >> phoneNum >> city;
-        if (input_file) {
-            toUpperCase(fname);
-            toUpperCase(lname);
-            Contact newContact(fname, lname, phoneNum, city);
-
-            contactsQuickSort.push_back(newContact);
-            contactsMergeSort.push_back(newContact);
-            contactsInsertionSort.push_back(newContact);
-            contactsHeapSort.push_back(newContact);
-        }
-    }
-    input_file.close();
+    vector<Contact> contactsQuickSort = phonebook.contacts<Contact>();
+    vector<Contact> contactsMergeSort = contactsQuickSort;
+    vector<Contact> contactsInsertionSort = contactsQuickSort;
+    vector<Contact> contactsHeapSort = contactsQuickSort;
 
     cout << "Please enter the word to be queried: " << endl;
     string input, firstName, lastName;
@@ -426,7 +563,18 @@ void run() {
 
 }
 
-int main() {
+#include "SearchIndex.cpp"
+#include "ContactScan.cpp"
+#include "SortBenchmark.cpp"
+#include "ExternalSort.cpp"
+
+int main(int argc, char* argv[]) {
+    //sorting_algorithms --bench <contact file> [options] runs the non-interactive benchmark, see SortBenchmark.cpp
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runSortBenchmark(argc, argv);
+    //sorting_algorithms --external-sort <contact file> <output file> [options] sorts a file larger than memory, see ExternalSort.cpp
+    if (argc > 1 && string(argv[1]) == "--external-sort")
+        return runExternalSort(argc, argv);
     run();
     return 0;
 }
@@ -0,0 +1,322 @@
+/*
+Implementation of the concurrent phonebook hash table.
+Written by Hagverdi Ibrahimli
+
+The table is split into shards chosen by the high bits of the name hash. Every shard is an open addressing table with
+its own writer lock, element count and rehash, so writers to different shards never wait for each other.
+Lookups take no lock. Each slot holds a pointer to an immutable contact and the high half of its hash, guarded by a
+per-slot sequence number (seqlock): a writer makes it odd while it changes the slot, and a reader retries a slot
+whose sequence number was odd or changed while it was read.
+Removed contacts and replaced shard tables are not freed at once but retired, and freed by epoch based reclamation
+when no lookup that could still see them is running.
+*/
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#define CONCURRENT_SHARD_COUNT 64 //default number of shards, a power of two
+#define CONCURRENT_MAX_THREADS 256 //threads that can use concurrent tables at the same time
+#define RECLAIM_BATCH 64 //retired objects of a shard that trigger an attempt to free them
+
+//Epoch based reclamation shared by all concurrent tables.
+//A reader announces the global epoch for the duration of a lookup; the epoch only advances once every running lookup
+//has announced the current one, and an object retired in epoch e is freed once the epoch reaches e + 2.
+class EpochReclaimer {
+public:
+	static EpochReclaimer& instance() {
+		static EpochReclaimer reclaimer;
+		return reclaimer;
+	}
+	//the calling thread's announcement slot, claimed on its first use and released when the thread exits
+	atomic<uint64_t>& localEpoch() {
+		thread_local ThreadSlot slot(*this);
+		return threads[slot.index].epoch;
+	}
+	uint64_t currentEpoch() const {
+		return globalEpoch.load();
+	}
+	//advances the epoch if no lookup is running in an older one, returns the current epoch
+	uint64_t tryAdvance() {
+		uint64_t epoch = globalEpoch.load();
+		for (int i = 0; i < CONCURRENT_MAX_THREADS; i++) {
+			uint64_t announced = threads[i].epoch.load();
+			if (announced != 0 && announced != epoch)
+				return epoch;
+		}
+		globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+		return globalEpoch.load();
+	}
+private:
+	struct alignas(64) ThreadState {
+		atomic<uint64_t> epoch{ 0 }; //0 when the thread is not inside a lookup
+		atomic<bool> used{ false };
+	};
+	struct ThreadSlot {
+		EpochReclaimer& owner;
+		int index;
+		ThreadSlot(EpochReclaimer& owner) : owner(owner), index(-1) {
+			for (;;) {
+				for (int i = 0; i < CONCURRENT_MAX_THREADS; i++) {
+					bool expected = false;
+					if (owner.threads[i].used.compare_exchange_strong(expected, true)) {
+						index = i;
+						return;
+					}
+				}
+				this_thread::yield(); //all slots are taken, wait for a thread to exit
+			}
+		}
+		~ThreadSlot() {
+			owner.threads[index].used.store(false);
+		}
+	};
+	ThreadState threads[CONCURRENT_MAX_THREADS];
+	atomic<uint64_t> globalEpoch{ 1 };
+};
+
+//Marks the calling thread as inside a lookup for its lifetime
+class EpochGuard {
+public:
+	EpochGuard() : epoch(EpochReclaimer::instance().localEpoch()) {
+		EpochReclaimer& reclaimer = EpochReclaimer::instance();
+		uint64_t announced;
+		//announce until the announcement is not already stale, so nothing retired after it can be freed under the lookup
+		do {
+			announced = reclaimer.currentEpoch();
+			epoch.store(announced);
+		} while (announced != reclaimer.currentEpoch());
+	}
+	~EpochGuard() {
+		epoch.store(0, memory_order_release);
+	}
+private:
+	atomic<uint64_t>& epoch;
+};
+
+template <class Hasher>
+class BasicConcurrentHashTable {
+private:
+	struct Slot {
+		atomic<uint32_t> sequence; //odd while a writer changes the slot
+		atomic<uint32_t> tag; //high half of the hash of the contact
+		atomic<const Contact*> contact; //NULL for an empty slot, deletedMarker() for a deleted one
+	};
+	struct Table {
+		int size;
+		unique_ptr<Slot[]> slots;
+		Table(int size) : size(size), slots(new Slot[size]()) {}
+	};
+	struct Retired {
+		uint64_t epoch;
+		const Contact* contact;
+		Table* table;
+	};
+	struct alignas(64) Shard {
+		mutex writeLock;
+		atomic<Table*> table;
+		atomic<int> currentSize; //written under writeLock, read without it by getAllItemSize
+		int deletedCount;
+		vector<Retired> retired;
+	};
+	vector<unique_ptr<Shard>> shards;
+	int shardBits;
+	double loadFactor;
+
+	/*private methods*/
+	static const Contact* deletedMarker() {
+		static const Contact marker;
+		return &marker;
+	}
+	Shard& shardOf(uint64_t h) const {
+		return *shards[shardBits == 0 ? 0 : h >> (64 - shardBits)];
+	}
+	static uint32_t tagOf(uint64_t h) {
+		return (uint32_t)(h >> 32);
+	}
+	static bool isContact(const Contact* contact) {
+		return contact != NULL && contact != deletedMarker();
+	}
+	//changes a slot of a published table, the shard's writeLock must be held
+	static void writeSlot(Slot& slot, uint32_t tag, const Contact* contact) {
+		uint32_t sequence = slot.sequence.load(memory_order_relaxed);
+		slot.sequence.store(sequence + 1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+		slot.tag.store(tag, memory_order_relaxed);
+		slot.contact.store(contact, memory_order_release);
+		slot.sequence.store(sequence + 2, memory_order_release);
+	}
+	//position of the active contact with the name, or -1; firstFree receives the first deleted or empty slot passed
+	//called by writers only, so the slots can be read directly
+	int findInShard(const Table& table, const string& firstName, const string& lastName, uint64_t h, int& firstFree) const {
+		const uint32_t tag = tagOf(h);
+		firstFree = -1;
+		int pos = Hasher::slot(h, table.size);
+		for (int probe = 0; ; ) {
+			const Contact* contact = table.slots[pos].contact.load(memory_order_relaxed);
+			if (contact == NULL) {
+				if (firstFree < 0)
+					firstFree = pos;
+				return -1;
+			}
+			if (contact == deletedMarker()) {
+				if (firstFree < 0)
+					firstFree = pos;
+			}
+			else if (table.slots[pos].tag.load(memory_order_relaxed) == tag && contact->firstName == firstName && contact->lastName == lastName)
+				return pos;
+			pos = Hasher::nextSlot(pos, ++probe, table.size);
+		}
+	}
+	//copies the contacts to a new table, doubled if the shard is really full, and publishes it
+	void rehash(Shard& shard) {
+		Table* oldTable = shard.table.load(memory_order_relaxed);
+		const int size = shard.currentSize.load(memory_order_relaxed) * 2 > loadFactor * oldTable->size ? oldTable->size * 2 : oldTable->size;
+		Table* newTable = new Table(Hasher::tableSize(size));
+		for (int i = 0; i < oldTable->size; i++) {
+			const Contact* contact = oldTable->slots[i].contact.load(memory_order_relaxed);
+			if (!isContact(contact))
+				continue;
+			uint64_t h = Hasher::hash(contact->firstName, contact->lastName);
+			int pos = Hasher::slot(h, newTable->size);
+			for (int probe = 0; newTable->slots[pos].contact.load(memory_order_relaxed) != NULL; )
+				pos = Hasher::nextSlot(pos, ++probe, newTable->size);
+			newTable->slots[pos].tag.store(tagOf(h), memory_order_relaxed);
+			newTable->slots[pos].contact.store(contact, memory_order_relaxed);
+		}
+		shard.table.store(newTable, memory_order_release);
+		shard.deletedCount = 0;
+		retire(shard, { 0, NULL, oldTable });
+	}
+	void retire(Shard& shard, Retired item) {
+		atomic_thread_fence(memory_order_seq_cst); //the object is unlinked before the epoch is read
+		item.epoch = EpochReclaimer::instance().currentEpoch();
+		shard.retired.push_back(item);
+		if (shard.retired.size() >= RECLAIM_BATCH)
+			reclaim(shard);
+	}
+	//frees the retired objects no lookup can see anymore
+	void reclaim(Shard& shard) {
+		const uint64_t epoch = EpochReclaimer::instance().tryAdvance();
+		size_t kept = 0;
+		for (Retired& item : shard.retired) {
+			if (item.epoch + 2 <= epoch) {
+				delete item.contact;
+				delete item.table;
+			}
+			else
+				shard.retired[kept++] = item;
+		}
+		shard.retired.resize(kept);
+	}
+public:
+	BasicConcurrentHashTable() : BasicConcurrentHashTable(CONCURRENT_SHARD_COUNT, lambda) {}
+	//shardCount is rounded up to a power of two
+	BasicConcurrentHashTable(int shardCount, double loadFactor) : shardBits(0), loadFactor(loadFactor) {
+		while ((1 << shardBits) < shardCount)
+			shardBits++;
+		for (int i = 0; i < (1 << shardBits); i++) {
+			shards.push_back(unique_ptr<Shard>(new Shard()));
+			shards.back()->table.store(new Table(Hasher::tableSize(16)));
+			shards.back()->currentSize.store(0);
+			shards.back()->deletedCount = 0;
+		}
+	}
+	//must not run concurrently with any other operation
+	~BasicConcurrentHashTable() {
+		for (unique_ptr<Shard>& shard : shards) {
+			Table* table = shard->table.load();
+			for (int i = 0; i < table->size; i++)
+				if (isContact(table->slots[i].contact.load()))
+					delete table->slots[i].contact.load();
+			delete table;
+			for (Retired& item : shard->retired) {
+				delete item.contact;
+				delete item.table;
+			}
+		}
+	}
+	BasicConcurrentHashTable(const BasicConcurrentHashTable&) = delete;
+	BasicConcurrentHashTable& operator=(const BasicConcurrentHashTable&) = delete;
+
+	//lock-free lookup
+	const Contact find(const string& firstName, const string& lastName) const {
+		const uint64_t h = Hasher::hash(firstName, lastName);
+		const uint32_t tag = tagOf(h);
+		EpochGuard guard;
+		const Table& table = *shardOf(h).table.load(memory_order_acquire);
+		int pos = Hasher::slot(h, table.size);
+		for (int probe = 0; ; ) {
+			const Slot& slot = table.slots[pos];
+			uint32_t sequence = slot.sequence.load(memory_order_acquire);
+			if (sequence & 1)
+				continue; //a writer is changing the slot, read it again
+			const uint32_t slotTag = slot.tag.load(memory_order_relaxed);
+			const Contact* contact = slot.contact.load(memory_order_acquire);
+			atomic_thread_fence(memory_order_acquire);
+			if (slot.sequence.load(memory_order_relaxed) != sequence)
+				continue;
+			if (contact == NULL)
+				return Contact(); //if the contact is not found, return an empty contact
+			if (contact != deletedMarker() && slotTag == tag && contact->firstName == firstName && contact->lastName == lastName)
+				return *contact;
+			pos = Hasher::nextSlot(pos, ++probe, table.size);
+		}
+	}
+	bool insert(const Contact& newContact) {
+		const uint64_t h = Hasher::hash(newContact.firstName, newContact.lastName);
+		Shard& shard = shardOf(h);
+		lock_guard<mutex> lock(shard.writeLock);
+		Table* table = shard.table.load(memory_order_relaxed);
+		int firstFree;
+		if (findInShard(*table, newContact.firstName, newContact.lastName, h, firstFree) >= 0)
+			return false; // if the contact already exists, return false
+		if (table->slots[firstFree].contact.load(memory_order_relaxed) == deletedMarker())
+			shard.deletedCount--;
+		writeSlot(table->slots[firstFree], tagOf(h), new Contact(newContact));
+		shard.currentSize.store(shard.currentSize.load(memory_order_relaxed) + 1, memory_order_relaxed);
+		//deleted slots also lengthen the probe sequences, so they count towards the load of the shard
+		if (shard.currentSize.load(memory_order_relaxed) + shard.deletedCount >= loadFactor * table->size)
+			rehash(shard);
+		return true;
+	}
+	bool remove(const string& firstName, const string& lastName) {
+		const uint64_t h = Hasher::hash(firstName, lastName);
+		Shard& shard = shardOf(h);
+		lock_guard<mutex> lock(shard.writeLock);
+		Table* table = shard.table.load(memory_order_relaxed);
+		int firstFree;
+		int pos = findInShard(*table, firstName, lastName, h, firstFree);
+		if (pos < 0)
+			return false; //if the contact is not found, return false
+		const Contact* contact = table->slots[pos].contact.load(memory_order_relaxed);
+		writeSlot(table->slots[pos], 0, deletedMarker());
+		shard.currentSize.store(shard.currentSize.load(memory_order_relaxed) - 1, memory_order_relaxed);
+		shard.deletedCount++;
+		retire(shard, { 0, contact, NULL });
+		return true;
+	}
+	//getters, exact only when no writer is running
+	int getAllItemSize() const {
+		int size = 0;
+		for (const unique_ptr<Shard>& shard : shards)
+			size += shard->currentSize.load(memory_order_relaxed);
+		return size;
+	}
+	int getTableSize() const {
+		EpochGuard guard;
+		int size = 0;
+		for (const unique_ptr<Shard>& shard : shards)
+			size += shard->table.load(memory_order_acquire)->size;
+		return size;
+	}
+	double getLoadFactor() const {
+		return (double)getAllItemSize() / getTableSize();
+	}
+	int getShardCount() const {
+		return shards.size();
+	}
+};
+
+//shards are chosen by the high bits of the hash, which the wyhash-style policy mixes well
+typedef BasicConcurrentHashTable<WyNameHasher> ConcurrentHashTable;
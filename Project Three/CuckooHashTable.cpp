@@ -0,0 +1,200 @@
+/*
+Implementation of the cuckoo hash table.
+Written by Hagverdi Ibrahimli
+
+Two tables of buckets with 4 slots each and a small stash. A name can only be in its bucket of the first table, its
+bucket of the second table (each chosen by a different reduction of the name hash) or in the stash, so a lookup
+examines at most 2 buckets and the stash whatever the load.
+An insert into two full buckets evicts an entry to its bucket in the other table, which may evict another one, and so
+on. When that does not end within CUCKOO_MAX_KICKS evictions the homeless entry goes to the stash, and when the stash
+is full the tables are doubled.
+*/
+
+#define CUCKOO_BUCKET_SIZE 4
+#define CUCKOO_STASH_SIZE 8
+#define CUCKOO_MAX_KICKS 500
+#define CUCKOO_MAX_LOAD 0.9 //default maximum load factor before the tables double
+
+class CuckooHashTable {
+private:
+	struct Entry {
+		Contact contact;
+		uint64_t hash;
+		bool used;
+		Entry() : hash(0), used(false) {}
+	};
+	vector<Entry> tables[2]; //bucket b of a table is slots [b * CUCKOO_BUCKET_SIZE, (b + 1) * CUCKOO_BUCKET_SIZE)
+	vector<Entry> stash;
+	int bucketBits; //log2 of the buckets per table
+	int currentSize;
+	double maxLoadFactor;
+	unsigned kickCounter; //picks the evicted slot of a bucket
+
+	/*private methods*/
+	size_t bucket(int table, uint64_t h) const {
+		//the second table uses a remixed hash so the two buckets of a name are independent
+		if (table == 1)
+			h = (h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ULL;
+		return (h * 0x9E3779B97F4A7C15ULL) >> (64 - bucketBits);
+	}
+	size_t capacity() const {
+		return 2 * tables[0].size();
+	}
+	//returns table * capacity + slot for a table slot, capacity + position for a stash entry, or -1
+	long long findIndex(const string& firstName, const string& lastName, uint64_t h) const {
+		for (int t = 0; t < 2; t++) {
+			size_t first = bucket(t, h) * CUCKOO_BUCKET_SIZE;
+			for (size_t i = first; i < first + CUCKOO_BUCKET_SIZE; i++) {
+				const Entry& entry = tables[t][i];
+				if (entry.used && entry.hash == h && entry.contact.firstName == firstName && entry.contact.lastName == lastName)
+					return t * tables[0].size() + i;
+			}
+		}
+		for (size_t i = 0; i < stash.size(); i++)
+			if (stash[i].hash == h && stash[i].contact.firstName == firstName && stash[i].contact.lastName == lastName)
+				return capacity() + i;
+		return -1;
+	}
+	Entry& entryAt(long long index) {
+		if (index >= (long long)capacity())
+			return stash[index - capacity()];
+		return tables[index / tables[0].size()][index % tables[0].size()];
+	}
+	//free slot of the entry's bucket in the table, or NULL
+	Entry* freeSlot(int table, uint64_t h) {
+		size_t first = bucket(table, h) * CUCKOO_BUCKET_SIZE;
+		for (size_t i = first; i < first + CUCKOO_BUCKET_SIZE; i++)
+			if (!tables[table][i].used)
+				return &tables[table][i];
+		return NULL;
+	}
+	//places the entry in the tables, evicting others as needed, then in the stash, then grows the tables
+	void place(Entry&& entry) {
+		for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+			for (int t = 0; t < 2; t++) {
+				Entry* slot = freeSlot(t, entry.hash);
+				if (slot != NULL) {
+					*slot = move(entry);
+					return;
+				}
+			}
+			//both buckets are full, evict an entry of one of them; it is retried in both of its buckets next round
+			const int t = kick & 1;
+			Entry& victim = tables[t][bucket(t, entry.hash) * CUCKOO_BUCKET_SIZE + (kickCounter++ % CUCKOO_BUCKET_SIZE)];
+			swap(victim, entry);
+		}
+		if (stash.size() < CUCKOO_STASH_SIZE) {
+			stash.push_back(move(entry));
+			return;
+		}
+		//the tables are too full, grow them and place everything again
+		rehash(bucketBits + 1, move(entry));
+	}
+	void allocate(int bits) {
+		bucketBits = bits;
+		for (int t = 0; t < 2; t++) {
+			tables[t].clear();
+			tables[t].resize(((size_t)1 << bits) * CUCKOO_BUCKET_SIZE);
+		}
+	}
+	//rebuilds the tables with 2^bits buckets each, with extra added to the entries
+	void rehash(int bits, Entry&& extra) {
+		vector<Entry> entries;
+		entries.reserve(currentSize + 1);
+		for (int t = 0; t < 2; t++)
+			for (Entry& entry : tables[t])
+				if (entry.used)
+					entries.push_back(move(entry));
+		for (Entry& entry : stash)
+			entries.push_back(move(entry));
+		entries.push_back(move(extra));
+		stash.clear();
+		allocate(bits);
+		for (Entry& entry : entries)
+			place(move(entry));
+	}
+public:
+	CuckooHashTable() : CuckooHashTable(INITIAL_TABLE_SIZE, CUCKOO_MAX_LOAD) {}
+	//size is the total number of slots of both tables, rounded up to a power of two buckets per table, and at least two
+	//buckets per table so bucket() shifts by less than 64 bits
+	CuckooHashTable(int size, double maxLoadFactor) : currentSize(0), maxLoadFactor(maxLoadFactor), kickCounter(0) {
+		int bits = 1;
+		while (((size_t)2 << bits) * CUCKOO_BUCKET_SIZE < (size_t)size)
+			bits++;
+		allocate(bits);
+	}
+
+	bool remove(const string& firstName, const string& lastName) {
+		long long index = findIndex(firstName, lastName, WyNameHasher::hash(firstName, lastName));
+		if (index < 0)
+			return false; //if the contact is not found, return false
+		if (index >= (long long)capacity())
+			stash.erase(stash.begin() + (index - capacity()));
+		else
+			entryAt(index) = Entry();
+		currentSize--;
+		return true; //if the contact is found and deleted, return true
+	}
+
+	const Contact find(const string& firstName, const string& lastName) const {
+		long long index = findIndex(firstName, lastName, WyNameHasher::hash(firstName, lastName));
+		if (index < 0)
+			return Contact(); //if the contact is not found, return an empty contact
+		if (index >= (long long)capacity())
+			return stash[index - capacity()].contact;
+		return tables[index / tables[0].size()][index % tables[0].size()].contact;
+	}
+	//inserting a new contact to the table
+	bool insert(const Contact& newContact) {
+		uint64_t h = WyNameHasher::hash(newContact.firstName, newContact.lastName);
+		if (findIndex(newContact.firstName, newContact.lastName, h) >= 0)
+			return false; // if the contact already exists, return false
+		Entry entry;
+		entry.contact = newContact;
+		entry.hash = h;
+		entry.used = true;
+		if (currentSize + 1 > maxLoadFactor * capacity())
+			rehash(bucketBits + 1, move(entry));
+		else
+			place(move(entry));
+		currentSize++;
+		return true;
+	}
+	//probe lengths count the examined slots: the first bucket, then the second one, then the stash
+	HashProbeStats getProbeStats() const {
+		HashProbeStats stats = { currentSize, 0, 0, 0, 0, 0 };
+		long long hitProbes = 0;
+		for (int t = 0; t < 2; t++)
+			for (size_t i = 0; i < tables[t].size(); i++) {
+				if (!tables[t][i].used)
+					continue;
+				int length = t * CUCKOO_BUCKET_SIZE + i % CUCKOO_BUCKET_SIZE + 1;
+				hitProbes += length;
+				stats.maxHitProbes = max(stats.maxHitProbes, length);
+			}
+		for (size_t i = 0; i < stash.size(); i++) {
+			int length = 2 * CUCKOO_BUCKET_SIZE + i + 1;
+			hitProbes += length;
+			stats.maxHitProbes = max(stats.maxHitProbes, length);
+		}
+		stats.averageHitProbes = currentSize > 0 ? (double)hitProbes / currentSize : 0;
+		stats.averageMissProbes = 2 * CUCKOO_BUCKET_SIZE + stash.size();
+		return stats;
+	}
+	//getters
+	double getLoadFactor() const {
+		return ((double)currentSize / (double)capacity());
+	}
+
+	int getTableSize() const {
+		return capacity();
+	}
+
+	int getAllItemSize() const {
+		return currentSize;
+	}
+
+	int getStashSize() const {
+		return stash.size();
+	}
+};
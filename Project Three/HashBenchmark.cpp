@@ -0,0 +1,667 @@
+/*
+Non-interactive benchmark of the hash table engines.
+Written by Hagverdi Ibrahimli
+
+Usage: HW4 --bench <contact file> [key=value ...]
+	capacity=65536          number of slots of every table (the quadratic table uses the next prime)
+	loads=0.5,0.6,0.7,0.8,0.9   load factors to fill the tables to
+	queries=200000          lookups per measurement
+	growth=500000           inserts of the growth measurement, 0 skips it
+	churn=200000            remove/insert pairs of the churn measurement, 0 skips it
+	threads=1,2,4,...       thread counts of the concurrency measurement, by default powers of two up to the core count
+	threadops=1000000       operations per thread of the concurrency measurement, 0 skips it
+	sizes=1000,10000,100000 phonebook sizes of the search measurement
+	trials=10               repetitions of every search measurement, 0 skips it
+	zipf=0.99               skew of the Zipf query set
+	seed=1
+The contacts of the file are extended with generated names until each load factor is reached, so that every engine
+holds exactly the same keys at the same load. Tables are sized up front and never rehash during a measurement.
+The report gives ns per insert, per successful find and per unsuccessful find as CSV; quadratic_wy is the quadratic
+table with the WyNameHasher policy instead of the default one.
+The hasher measurement hashes every name of the file with each policy, then loads the file into a table with the
+default load factor and reports the hashing throughput, the probe lengths and the find times.
+The growth measurement then fills the quadratic table from INITIAL_TABLE_SIZE through all of its rehashes, once with
+the rehash done at once and once incrementally, and reports the latency distribution of the individual inserts.
+The churn measurement keeps the quadratic table at half load while removing a random contact and inserting a new one,
+and reports the deleted entries and probe lengths as the churn goes on.
+The concurrency measurement fills a table with 200000 contacts and runs a 95% find, 2.5% insert, 2.5% remove mix on
+every thread count, once on the quadratic table behind one mutex and once on the concurrent sharded table, and reports
+the throughput and the speedup over one thread.
+The probe measurement fills the quadratic, Robin Hood and cuckoo tables to every load factor and reports their probe
+lengths and the latency distribution of individual successful finds.
+The index measurement loads the file into the multi-key phonebook and compares lookups by name, phone number and city
+through its indexes with a scan of all the contacts.
+The startup measurement loads the file into the hash table once growing from INITIAL_TABLE_SIZE and once sized for
+the file up front, and writes it to a mapped table file in the temporary directory which it then opens; it reports the
+time until the first find can run and the find times of each.
+The search measurement compares the hash table with the BST at every phonebook size on three shuffled query sets:
+hits, misses and Zipf distributed hits. Every set is run once to warm up and then trials times; the report gives the
+mean ns per find with its 95% confidence interval. Every find result is consumed, so no find can be optimized away.
+The _lookup rows use the lookup that returns a pointer into the structure instead of a copy of the contact.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+struct HashBenchmarkConfig {
+	string fileName;
+	int capacity = 65536;
+	vector<double> loads = { 0.5, 0.6, 0.7, 0.8, 0.9 };
+	int queries = 200000;
+	int growth = 500000;
+	int churn = 200000;
+	vector<int> threads;
+	int threadOps = 1000000;
+	vector<int> sizes = { 1000, 10000, 100000 };
+	int trials = 10;
+	double zipf = 0.99;
+	unsigned seed = 1;
+};
+
+struct HashBenchmarkResult {
+	string engine;
+	double load;
+	int items;
+	double insertNs;
+	double hitNs;
+	double missNs;
+};
+
+int benchmarkPrime(int n) {
+	for (;; n++) {
+		bool prime = n > 1;
+		for (int i = 2; i * i <= n && prime; i++)
+			if (n % i == 0)
+				prime = false;
+		if (prime)
+			return n;
+	}
+}
+
+bool parseHashBenchmarkArgs(int argc, char* argv[], HashBenchmarkConfig& config) {
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " --bench <contact file> [capacity=N] [loads=0.5,0.7,0.9] [queries=N] [growth=N] [churn=N] [threads=1,2,4] [threadops=N] [sizes=1000,10000] [trials=N] [zipf=S] [seed=N]" << endl;
+		return false;
+	}
+	config.fileName = argv[2];
+	for (int i = 3; i < argc; i++) {
+		string arg = argv[i];
+		size_t eq = arg.find('=');
+		string key = arg.substr(0, eq);
+		string value = (eq == string::npos) ? "" : arg.substr(eq + 1);
+		//stoi, stod and stoul throw on a value that is not a number or does not fit
+		try {
+			if (key == "capacity" && !value.empty())
+				config.capacity = stoi(value);
+			else if (key == "queries" && !value.empty())
+				config.queries = stoi(value);
+			else if (key == "growth" && !value.empty())
+				config.growth = stoi(value);
+			else if (key == "churn" && !value.empty())
+				config.churn = stoi(value);
+			else if (key == "threadops" && !value.empty())
+				config.threadOps = stoi(value);
+			else if (key == "threads" && !value.empty()) {
+				stringstream ss(value);
+				string count;
+				while (getline(ss, count, ','))
+					config.threads.push_back(stoi(count));
+			}
+			else if (key == "trials" && !value.empty())
+				config.trials = stoi(value);
+			else if (key == "zipf" && !value.empty())
+				config.zipf = stod(value);
+			else if (key == "sizes" && !value.empty()) {
+				config.sizes.clear();
+				stringstream ss(value);
+				string size;
+				while (getline(ss, size, ','))
+					config.sizes.push_back(stoi(size));
+			}
+			else if (key == "seed" && !value.empty())
+				config.seed = stoul(value);
+			else if (key == "loads" && !value.empty()) {
+				config.loads.clear();
+				stringstream ss(value);
+				string load;
+				while (getline(ss, load, ','))
+					config.loads.push_back(stod(load));
+			}
+			else {
+				cerr << "Invalid benchmark argument: " << arg << endl;
+				return false;
+			}
+		}
+		catch (const invalid_argument&) {
+			cerr << "Invalid benchmark argument: " << arg << endl;
+			return false;
+		}
+		catch (const out_of_range&) {
+			cerr << "Invalid benchmark argument: " << arg << endl;
+			return false;
+		}
+	}
+	if (config.threads.empty())
+		for (int count = 1; count <= (int)max(1u, thread::hardware_concurrency()); count *= 2)
+			config.threads.push_back(count);
+	for (int count : config.threads) {
+		if (count <= 0 || count > CONCURRENT_MAX_THREADS) {
+			cerr << "Thread counts must be between 1 and " << CONCURRENT_MAX_THREADS << "." << endl;
+			return false;
+		}
+	}
+	for (int size : config.sizes) {
+		if (size <= 0) {
+			cerr << "Sizes must be positive." << endl;
+			return false;
+		}
+	}
+	for (double load : config.loads) {
+		if (load <= 0 || load >= 0.95) {
+			cerr << "Load factors must be between 0 and 0.95." << endl;
+			return false;
+		}
+	}
+	return config.capacity > 0 && config.queries > 0 && config.growth >= 0 && config.churn >= 0 && config.threadOps >= 0 && config.trials >= 0 && config.zipf > 0;
+}
+
+long long latencyPercentile(const vector<long long>& sorted, double p) {
+	size_t index = (size_t)(p * sorted.size());
+	return sorted[min(index, sorted.size() - 1)];
+}
+
+//Times every insert while the table grows from its initial size, with one or the other rehash mode
+void benchmarkGrowth(const string& mode, bool incremental, const vector<Contact>& keys, long long& checksum) {
+	HashTable table(INITIAL_TABLE_SIZE, lambda, incremental);
+	table.setVerbose(false);
+	vector<long long> latencies;
+	latencies.reserve(keys.size());
+	auto start = chrono::steady_clock::now();
+	for (const Contact& key : keys) {
+		auto insertStart = chrono::steady_clock::now();
+		checksum += table.insert(key);
+		latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - insertStart).count());
+	}
+	double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	sort(latencies.begin(), latencies.end());
+	cout << mode << "," << keys.size() << "," << table.getTableSize() << "," << latencyPercentile(latencies, 0.50) << ","
+		<< latencyPercentile(latencies, 0.99) << "," << latencyPercentile(latencies, 0.999) << "," << latencies.back() << "," << totalMs << endl;
+}
+
+//Hashing throughput of a policy, then probe lengths and lookup times of a table loaded with the contacts of the file
+template <class Hasher>
+void benchmarkHasher(const string& name, const vector<Contact>& contacts, const vector<int>& hitOrder, const vector<Contact>& misses, long long& checksum) {
+	size_t bytes = 0;
+	for (const Contact& c : contacts)
+		bytes += c.firstName.size() + c.lastName.size();
+	const int rounds = max<size_t>(1, 2000000 / contacts.size());
+	auto start = chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+		for (const Contact& c : contacts)
+			checksum += Hasher::hash(c.firstName, c.lastName) >> 60;
+	double hashNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+	BasicHashTable<Hasher> table(INITIAL_TABLE_SIZE, lambda);
+	table.setVerbose(false);
+	for (const Contact& c : contacts)
+		table.insert(c);
+	HashProbeStats stats = table.getProbeStats();
+	start = chrono::steady_clock::now();
+	for (int index : hitOrder)
+		checksum += table.find(contacts[index].firstName, contacts[index].lastName).phoneNumber.size();
+	double hitNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / hitOrder.size();
+	start = chrono::steady_clock::now();
+	for (const Contact& miss : misses)
+		checksum += table.find(miss.firstName, miss.lastName).phoneNumber.size();
+	double missNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / misses.size();
+
+	cout << name << "," << hashNs / ((double)rounds * contacts.size()) << "," << rounds * bytes / (hashNs / 1e9) / 1e6 << "," << table.getTableSize() << ","
+		<< stats.averageHitProbes << "," << stats.maxHitProbes << "," << stats.averageMissProbes << "," << hitNs << "," << missNs << endl;
+}
+
+//The quadratic probing table made safe for threads by one mutex around every operation
+class LockedHashTable {
+public:
+	LockedHashTable() {
+		table.setVerbose(false);
+	}
+	const Contact find(const string& firstName, const string& lastName) {
+		lock_guard<mutex> lock(tableLock);
+		return table.find(firstName, lastName);
+	}
+	bool insert(const Contact& newContact) {
+		lock_guard<mutex> lock(tableLock);
+		return table.insert(newContact);
+	}
+	bool remove(const string& firstName, const string& lastName) {
+		lock_guard<mutex> lock(tableLock);
+		return table.remove(firstName, lastName);
+	}
+private:
+	mutex tableLock;
+	HashTable table;
+};
+
+//Runs threadOps operations of the 95/5 read/write mix on every thread, returns the total operations per second
+template <class Table>
+double runConcurrentMix(Table& table, const vector<Contact>& keys, int threadCount, int threadOps, unsigned seed, long long& checksum) {
+	vector<thread> workers;
+	vector<long long> sums(threadCount, 0);
+	auto start = chrono::steady_clock::now();
+	for (int t = 0; t < threadCount; t++) {
+		workers.push_back(thread([&, t]() {
+			mt19937 generator(seed + t);
+			uniform_int_distribution<int> pick(0, keys.size() - 1), mix(0, 999);
+			long long sum = 0;
+			for (int op = 0; op < threadOps; op++) {
+				const Contact& key = keys[pick(generator)];
+				int kind = mix(generator);
+				if (kind < 950)
+					sum += table.find(key.firstName, key.lastName).phoneNumber.size();
+				else if (kind < 975)
+					sum += table.insert(key);
+				else
+					sum += table.remove(key.firstName, key.lastName);
+			}
+			sums[t] = sum;
+		}));
+	}
+	for (thread& worker : workers)
+		worker.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	for (long long sum : sums)
+		checksum += sum;
+	return (double)threadCount * threadOps / seconds;
+}
+
+template <class Table>
+void benchmarkConcurrency(const string& engine, const HashBenchmarkConfig& config, const vector<Contact>& keys, long long& checksum) {
+	double single = 0;
+	for (int threadCount : config.threads) {
+		Table table;
+		for (const Contact& key : keys)
+			table.insert(key);
+		double opsPerSecond = runConcurrentMix(table, keys, threadCount, config.threadOps, config.seed, checksum);
+		if (single == 0)
+			single = opsPerSecond / threadCount;
+		cout << engine << "," << threadCount << "," << opsPerSecond / 1e6 << "," << opsPerSecond / single << endl;
+	}
+}
+
+//Time of one lookup in ns, averaged over the queries
+template <class Lookup>
+double timeLookups(const vector<int>& order, Lookup lookup) {
+	auto start = chrono::steady_clock::now();
+	for (int index : order)
+		lookup(index);
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / order.size();
+}
+
+void benchmarkIndex(const vector<Contact>& contacts, int queries, mt19937& generator, long long& checksum) {
+	PhonebookIndex phonebook;
+	for (const Contact& c : contacts)
+		phonebook.insert(c);
+	//scans are much slower, so they get fewer queries
+	vector<int> order(queries), scanOrder(max(1, queries / 100));
+	for (int& index : order)
+		index = uniform_int_distribution<int>(0, contacts.size() - 1)(generator);
+	for (int& index : scanOrder)
+		index = uniform_int_distribution<int>(0, contacts.size() - 1)(generator);
+
+	cout << endl << "lookup,contacts,indexed_ns,scan_ns" << endl;
+	cout << "name," << phonebook.getAllItemSize() << "," << timeLookups(order, [&](int i) {
+		checksum += phonebook.find(contacts[i].firstName, contacts[i].lastName) != NULL;
+	}) << "," << timeLookups(scanOrder, [&](int i) {
+		for (const Contact& c : contacts)
+			if (c.firstName == contacts[i].firstName && c.lastName == contacts[i].lastName) {
+				checksum++;
+				break;
+			}
+	}) << endl;
+	cout << "phone," << phonebook.getAllItemSize() << "," << timeLookups(order, [&](int i) {
+		checksum += phonebook.findByPhone(contacts[i].phoneNumber).size();
+	}) << "," << timeLookups(scanOrder, [&](int i) {
+		for (const Contact& c : contacts)
+			checksum += c.phoneNumber == contacts[i].phoneNumber;
+	}) << endl;
+	cout << "city," << phonebook.getAllItemSize() << "," << timeLookups(order, [&](int i) {
+		checksum += phonebook.cityPostings(contacts[i].city).size();
+	}) << "," << timeLookups(scanOrder, [&](int i) {
+		for (const Contact& c : contacts)
+			checksum += c.city == contacts[i].city;
+	}) << endl;
+}
+
+//Probe lengths and the latency of individual successful finds of a table filled with keys
+template <class Table>
+void benchmarkProbes(const string& engine, Table& table, double load, const vector<Contact>& keys, const vector<int>& hitOrder, long long& checksum) {
+	for (const Contact& key : keys)
+		table.insert(key);
+	HashProbeStats stats = table.getProbeStats();
+	vector<long long> latencies;
+	latencies.reserve(hitOrder.size());
+	for (int index : hitOrder) {
+		auto start = chrono::steady_clock::now();
+		checksum += table.find(keys[index].firstName, keys[index].lastName).phoneNumber.size();
+		latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+	}
+	sort(latencies.begin(), latencies.end());
+	cout << engine << "," << load << "," << stats.averageHitProbes << "," << stats.maxHitProbes << "," << stats.averageMissProbes << ","
+		<< latencyPercentile(latencies, 0.50) << "," << latencyPercentile(latencies, 0.99) << "," << latencies.back() << endl;
+}
+
+//Mean and 95% confidence interval half-width of the samples, with Student's t for small sample counts
+void confidenceInterval(const vector<double>& samples, double& mean, double& halfWidth) {
+	static const double t975[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+	const int n = samples.size();
+	mean = 0;
+	for (double sample : samples)
+		mean += sample;
+	mean /= n;
+	if (n < 2) {
+		halfWidth = 0;
+		return;
+	}
+	double variance = 0;
+	for (double sample : samples)
+		variance += (sample - mean) * (sample - mean);
+	variance /= n - 1;
+	const double t = n - 1 <= 30 ? t975[n - 1] : 1.96;
+	halfWidth = t * sqrt(variance / n);
+}
+
+//Indices of keys drawn from a Zipf distribution with exponent s over a random popularity order of the keys
+vector<int> makeZipfQueries(int keyCount, int queries, double s, mt19937& generator) {
+	vector<double> cdf(keyCount);
+	double total = 0;
+	for (int rank = 0; rank < keyCount; rank++)
+		cdf[rank] = total += 1.0 / pow(rank + 1, s);
+	vector<int> popularity(keyCount);
+	for (int i = 0; i < keyCount; i++)
+		popularity[i] = i;
+	shuffle(popularity.begin(), popularity.end(), generator);
+	vector<int> order(queries);
+	uniform_real_distribution<double> uniform(0, total);
+	for (int& index : order)
+		index = popularity[lower_bound(cdf.begin(), cdf.end(), uniform(generator)) - cdf.begin()];
+	return order;
+}
+
+//Runs the queries once to warm up and then trials times, reporting the mean ns per find and its confidence interval.
+//find(query) searches one query and returns a value that depends on the result
+template <class Find>
+void benchmarkSearch(const string& structure, int size, const string& querySet, const vector<Contact>& queries,
+	int trials, long long& checksum, Find find) {
+	vector<double> samples;
+	for (int trial = 0; trial <= trials; trial++) {
+		auto start = chrono::steady_clock::now();
+		for (const Contact& query : queries)
+			checksum += find(query);
+		double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / queries.size();
+		if (trial > 0)
+			samples.push_back(ns);
+	}
+	double mean, halfWidth;
+	confidenceInterval(samples, mean, halfWidth);
+	cout << structure << "," << size << "," << querySet << "," << mean << "," << halfWidth << endl;
+}
+
+//The contacts of the file followed by generated variants of them, all with distinct names
+vector<Contact> makeBenchmarkKeys(const vector<Contact>& contacts, int count, const string& tag) {
+	vector<Contact> keys;
+	for (int i = 0; (int)keys.size() < count; i++) {
+		const Contact& base = contacts[i % contacts.size()];
+		if (i < (int)contacts.size() && tag.empty())
+			keys.push_back(base);
+		else
+			keys.push_back(Contact(base.firstName, base.lastName + tag + to_string(i), base.phoneNumber, base.city));
+	}
+	return keys;
+}
+
+//Removes a random stored contact and inserts a new one, churn times, reporting the probe statistics four times on the way
+void benchmarkChurn(int capacity, int churn, const vector<Contact>& contacts, mt19937& generator, long long& checksum) {
+	HashTable table(benchmarkPrime(capacity), 0.95);
+	const vector<Contact> keys = makeBenchmarkKeys(contacts, capacity / 2, "");
+	const vector<Contact> fresh = makeBenchmarkKeys(contacts, churn, "#CHURN");
+	vector<const Contact*> stored;
+	for (const Contact& key : keys)
+		if (table.insert(key))
+			stored.push_back(&key);
+	cout << endl << "churn_ops,items,deleted,cleanups,avg_hit_probes,max_hit_probes,avg_miss_probes,ns_per_op" << endl;
+	const int reportEvery = max(1, churn / 4);
+	auto start = chrono::steady_clock::now();
+	for (int op = 0; op <= churn; op++) {
+		if (op % reportEvery == 0 || op == churn) {
+			double opNs = op == 0 ? 0 : chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / reportEvery;
+			HashProbeStats stats = table.getProbeStats();
+			cout << op << "," << stats.activeCount << "," << stats.deletedCount << "," << stats.cleanups << "," << stats.averageHitProbes << ","
+				<< stats.maxHitProbes << "," << stats.averageMissProbes << "," << opNs << endl;
+			if (op == churn)
+				break;
+			start = chrono::steady_clock::now();
+		}
+		size_t victim = uniform_int_distribution<size_t>(0, stored.size() - 1)(generator);
+		checksum += table.remove(stored[victim]->firstName, stored[victim]->lastName);
+		checksum += table.insert(fresh[op]);
+		stored[victim] = &fresh[op];
+	}
+}
+
+template <class Table>
+HashBenchmarkResult benchmarkTable(const string& engine, Table& table, double load, const vector<Contact>& keys,
+	const vector<int>& hitOrder, const vector<Contact>& misses, long long& checksum) {
+	auto start = chrono::steady_clock::now();
+	int items = 0;
+	for (const Contact& key : keys)
+		items += table.insert(key);
+	auto insertTime = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (int index : hitOrder)
+		checksum += table.find(keys[index].firstName, keys[index].lastName).phoneNumber.size();
+	auto hitTime = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (const Contact& miss : misses)
+		checksum += table.find(miss.firstName, miss.lastName).phoneNumber.size();
+	auto missTime = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+	return { engine, load, items, insertTime / keys.size(), hitTime / hitOrder.size(), missTime / misses.size() };
+}
+
+//Time to build or open a phonebook that can answer finds, then the finds themselves, for the in-memory and mapped tables
+void benchmarkStartup(const vector<Contact>& contacts, int queries, mt19937& generator, long long& checksum) {
+	vector<int> order(queries);
+	for (int& index : order)
+		index = uniform_int_distribution<int>(0, contacts.size() - 1)(generator);
+	const vector<Contact> misses = makeBenchmarkKeys(contacts, queries, "#MISS");
+	vector<int> missOrder(queries);
+	for (int i = 0; i < queries; i++)
+		missOrder[i] = i;
+
+	cout << endl << "table,contacts,table_size,build_ms,ready_ms,find_hit_ns,find_miss_ns" << endl;
+	for (int presize = 0; presize < 2; presize++) {
+		auto start = chrono::steady_clock::now();
+		HashTable table(INITIAL_TABLE_SIZE, lambda);
+		table.setVerbose(false);
+		if (presize)
+			table.reserve(contacts.size());
+		for (const Contact& c : contacts)
+			table.insert(c);
+		double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		cout << (presize ? "hashtable_presized," : "hashtable,") << table.getAllItemSize() << "," << table.getTableSize() << ","
+			<< buildMs << "," << buildMs << "," << timeLookups(order, [&](int i) {
+			checksum += table.contains(contacts[i].firstName, contacts[i].lastName);
+		}) << "," << timeLookups(missOrder, [&](int i) {
+			checksum += table.contains(misses[i].firstName, misses[i].lastName);
+		}) << endl;
+	}
+	const string fileName = (filesystem::temp_directory_path() / "hw4_benchmark.table").string();
+	auto start = chrono::steady_clock::now();
+	if (!MappedPhonebook::build(contacts, fileName, generator())) {
+		cerr << "Error writing the table file " << fileName << endl;
+		return;
+	}
+	double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	{
+		start = chrono::steady_clock::now();
+		MappedPhonebook table;
+		if (table.open(fileName)) {
+			double readyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			cout << "mapped," << table.getAllItemSize() << "," << table.getTableSize() << "," << buildMs << "," << readyMs << "," << timeLookups(order, [&](int i) {
+				checksum += table.contains(contacts[i].firstName, contacts[i].lastName);
+			}) << "," << timeLookups(missOrder, [&](int i) {
+				checksum += table.contains(misses[i].firstName, misses[i].lastName);
+			}) << endl;
+		}
+		else
+			cerr << "Error opening the table file " << fileName << endl;
+	}
+	remove(fileName.c_str());
+}
+
+int runHashBenchmark(int argc, char* argv[]) {
+	HashBenchmarkConfig config;
+	if (!parseHashBenchmarkArgs(argc, argv, config))
+		return 1;
+	PhonebookFile phonebook;
+	if (!phonebook.load(config.fileName, UPPERCASE_NAMES) || phonebook.size() == 0) {
+		cerr << "Error opening file. Please try again." << endl;
+		return 1;
+	}
+	const vector<Contact> contacts = phonebook.contacts<Contact>();
+	mt19937 generator(config.seed);
+	long long checksum = 0;
+	vector<HashBenchmarkResult> results;
+
+	for (double load : config.loads) {
+		const int count = (int)(load * config.capacity);
+		const vector<Contact> keys = makeBenchmarkKeys(contacts, count, "");
+		const vector<Contact> misses = makeBenchmarkKeys(contacts, config.queries, "#MISS");
+		vector<int> hitOrder(config.queries);
+		for (int& index : hitOrder)
+			index = uniform_int_distribution<int>(0, count - 1)(generator);
+
+		{
+			//the quadratic probing table never rehashes below its load factor argument
+			HashTable table(benchmarkPrime(config.capacity), 0.95);
+			results.push_back(benchmarkTable("quadratic", table, load, keys, hitOrder, misses, checksum));
+		}
+		{
+			BasicHashTable<WyNameHasher> table(config.capacity, 0.95);
+			results.push_back(benchmarkTable("quadratic_wy", table, load, keys, hitOrder, misses, checksum));
+		}
+		{
+			SwissHashTable table(config.capacity, 0.95);
+			results.push_back(benchmarkTable("swiss", table, load, keys, hitOrder, misses, checksum));
+		}
+	}
+
+	cout << "engine,load_factor,items,insert_ns,find_hit_ns,find_miss_ns" << endl;
+	for (const HashBenchmarkResult& r : results)
+		cout << r.engine << "," << r.load << "," << r.items << "," << r.insertNs << "," << r.hitNs << "," << r.missNs << endl;
+
+	cout << endl << "engine,load_factor,avg_hit_probes,max_hit_probes,avg_miss_probes,find_p50_ns,find_p99_ns,find_max_ns" << endl;
+	for (double load : config.loads) {
+		const int count = (int)(load * config.capacity);
+		const vector<Contact> keys = makeBenchmarkKeys(contacts, count, "");
+		vector<int> hitOrder(config.queries);
+		for (int& index : hitOrder)
+			index = uniform_int_distribution<int>(0, count - 1)(generator);
+		{
+			HashTable table(benchmarkPrime(config.capacity), 0.95);
+			benchmarkProbes("quadratic", table, load, keys, hitOrder, checksum);
+		}
+		{
+			RobinHoodHashTable table(config.capacity, 0.95);
+			benchmarkProbes("robinhood", table, load, keys, hitOrder, checksum);
+		}
+		{
+			CuckooHashTable table(config.capacity, 0.95);
+			benchmarkProbes("cuckoo", table, load, keys, hitOrder, checksum);
+		}
+	}
+
+	{
+		const vector<Contact> misses = makeBenchmarkKeys(contacts, config.queries, "#MISS");
+		vector<int> hitOrder(config.queries);
+		for (int& index : hitOrder)
+			index = uniform_int_distribution<int>(0, contacts.size() - 1)(generator);
+		cout << endl << "hasher,hash_ns,hash_mb_s,table_size,avg_hit_probes,max_hit_probes,avg_miss_probes,find_hit_ns,find_miss_ns" << endl;
+		benchmarkHasher<DjbNameHasher>("djb2", contacts, hitOrder, misses, checksum);
+		benchmarkHasher<WyNameHasher>("wyhash", contacts, hitOrder, misses, checksum);
+	}
+	if (config.growth > 0) {
+		const vector<Contact> keys = makeBenchmarkKeys(contacts, config.growth, "");
+		cout << endl << "rehash,inserts,final_table_size,p50_ns,p99_ns,p999_ns,max_ns,total_ms" << endl;
+		benchmarkGrowth("full", false, keys, checksum);
+		benchmarkGrowth("incremental", true, keys, checksum);
+	}
+	if (config.churn > 0)
+		benchmarkChurn(config.capacity, config.churn, contacts, generator, checksum);
+	benchmarkIndex(contacts, config.queries, generator, checksum);
+	benchmarkStartup(contacts, config.queries, generator, checksum);
+	if (config.trials > 0) {
+		cout << endl << "structure,size,query_set,mean_ns,ci95_ns" << endl;
+		for (int size : config.sizes) {
+			vector<Contact> keys = makeBenchmarkKeys(contacts, size, "");
+			//a BST built in file order would reflect the file's sort order rather than the structure
+			shuffle(keys.begin(), keys.end(), generator);
+			BinarySearchTree<Contact> tree;
+			HashTable table(INITIAL_TABLE_SIZE, lambda);
+			table.setVerbose(false);
+			for (const Contact& key : keys) {
+				tree.insert(key);
+				table.insert(key);
+			}
+			const int queryCount = min(config.queries, 100000);
+			vector<Contact> hits(queryCount), zipfHits(queryCount);
+			for (Contact& query : hits)
+				query = keys[uniform_int_distribution<int>(0, size - 1)(generator)];
+			vector<int> zipfOrder = makeZipfQueries(size, queryCount, config.zipf, generator);
+			for (int i = 0; i < queryCount; i++)
+				zipfHits[i] = keys[zipfOrder[i]];
+			vector<Contact> misses = makeBenchmarkKeys(contacts, queryCount, "#MISS");
+			shuffle(misses.begin(), misses.end(), generator);
+			auto tableFind = [&](const Contact& query) {
+				const Contact found = table.find(query.firstName, query.lastName);
+				doNotOptimize(found);
+				return found.phoneNumber.size();
+			};
+			auto tableLookup = [&](const Contact& query) {
+				const Contact* found = table.lookup(query.firstName, query.lastName);
+				doNotOptimize(found);
+				return found != NULL ? found->phoneNumber.size() : 0;
+			};
+			auto treeFind = [&](const Contact& query) {
+				const Contact found = tree.find(query.firstName, query.lastName);
+				doNotOptimize(found);
+				return found.phoneNumber.size();
+			};
+			auto treeLookup = [&](const Contact& query) {
+				const Contact* found = tree.lookup(query.firstName, query.lastName);
+				doNotOptimize(found);
+				return found != NULL ? found->phoneNumber.size() : 0;
+			};
+			const vector<Contact>* querySets[] = { &hits, &misses, &zipfHits };
+			const string querySetNames[] = { "hit", "miss", "zipf" };
+			for (int set = 0; set < 3; set++) {
+				benchmarkSearch("hashtable", size, querySetNames[set], *querySets[set], config.trials, checksum, tableFind);
+				benchmarkSearch("hashtable_lookup", size, querySetNames[set], *querySets[set], config.trials, checksum, tableLookup);
+				benchmarkSearch("bst", size, querySetNames[set], *querySets[set], config.trials, checksum, treeFind);
+				benchmarkSearch("bst_lookup", size, querySetNames[set], *querySets[set], config.trials, checksum, treeLookup);
+			}
+		}
+	}
+	if (config.threadOps > 0) {
+		const vector<Contact> keys = makeBenchmarkKeys(contacts, 200000, "");
+		cout << endl << "engine,threads,mops,speedup" << endl;
+		benchmarkConcurrency<LockedHashTable>("locked", config, keys, checksum);
+		benchmarkConcurrency<ConcurrentHashTable>("concurrent", config, keys, checksum);
+	}
+	cerr << "checksum: " << checksum << endl;
+	return 0;
+}
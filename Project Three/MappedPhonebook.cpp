@@ -0,0 +1,233 @@
+/*
+Implementation of the memory-mapped phonebook table.
+Written by Hagverdi Ibrahimli
+
+A read-only hash table stored in a file, built once from the contacts and then queried in place through mmap, so
+opening it costs the same for any number of contacts and nothing is parsed or rehashed at startup.
+File layout, every integer in the byte order of the machine that built it:
+	header       magic, version, log2 of the slot count, hash seed, contact count, offsets and sizes of the two parts
+	slot array   2^slotBits slots of { 32-bit hash tag, 32-bit record offset }; offset 0 marks an empty slot
+	string heap  records of { four 32-bit field lengths, firstName, lastName, phoneNumber, city }, 4-byte aligned
+Record offsets count 4-byte units from the start of the heap, whose first 4 bytes are unused so that no record is at 0.
+Slots are found with WyNameHasher seeded with the header's seed, Fibonacci reduction and triangular probing.
+*/
+
+#define MAPPED_TABLE_MAGIC "PHBKHT1"
+#define MAPPED_TABLE_VERSION 1
+#define MAPPED_TABLE_LOAD 0.5 //load factor of the slot array
+#define MAPPED_TABLE_MAX_SLOT_BITS 30 //the slot count and the slot positions are ints, so 2^30 slots at most
+
+struct MappedTableHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t slotBits;
+	uint64_t seed;
+	uint64_t count;
+	uint64_t slotOffset; //from the start of the file
+	uint64_t heapOffset;
+	uint64_t heapSize;
+};
+
+struct MappedTableSlot {
+	uint32_t tag; //high 32 bits of the name hash
+	uint32_t offset;
+};
+
+//Fields of a contact in the mapped file, valid while the table is open
+struct MappedContact {
+	string_view firstName;
+	string_view lastName;
+	string_view phoneNumber;
+	string_view city;
+	Contact toContact() const {
+		return Contact(string(firstName), string(lastName), string(phoneNumber), string(city));
+	}
+};
+
+class MappedPhonebook {
+private:
+	const char* data;
+	size_t dataSize;
+	const MappedTableHeader* header;
+	const MappedTableSlot* slots;
+	const char* heap;
+#ifdef _WIN32
+	string fileBuffer;
+#endif
+
+	/*private methods*/
+	//fields of the record at offset; false if the record does not fit in the heap
+	bool readRecord(uint32_t offset, MappedContact& contact) const {
+		const uint64_t start = (uint64_t)offset * 4;
+		if (start + 16 > header->heapSize)
+			return false;
+		uint32_t length[4];
+		memcpy(length, heap + start, 16);
+		const uint64_t total = (uint64_t)length[0] + length[1] + length[2] + length[3];
+		if (start + 16 + total > header->heapSize)
+			return false;
+		const char* field = heap + start + 16;
+		contact.firstName = string_view(field, length[0]);
+		contact.lastName = string_view(field += length[0], length[1]);
+		contact.phoneNumber = string_view(field += length[1], length[2]);
+		contact.city = string_view(field += length[2], length[3]);
+		return true;
+	}
+	//checks that the header describes a table that fits in the file
+	bool validate() const {
+		if (dataSize < sizeof(MappedTableHeader))
+			return false;
+		if (memcmp(header->magic, MAPPED_TABLE_MAGIC, sizeof(header->magic)) != 0 || header->version != MAPPED_TABLE_VERSION)
+			return false;
+		if (header->slotBits < 1 || header->slotBits > MAPPED_TABLE_MAX_SLOT_BITS || header->count >= ((uint64_t)1 << header->slotBits))
+			return false;
+		const uint64_t slotBytes = ((uint64_t)1 << header->slotBits) * sizeof(MappedTableSlot);
+		return header->slotOffset % alignof(MappedTableSlot) == 0 && header->slotOffset <= dataSize && slotBytes <= dataSize - header->slotOffset
+			&& header->heapOffset <= dataSize && header->heapSize <= dataSize - header->heapOffset;
+	}
+	void unmap() {
+#ifdef _WIN32
+		fileBuffer.clear();
+#else
+		if (data != NULL)
+			munmap(const_cast<char*>(data), dataSize);
+#endif
+		data = NULL;
+		dataSize = 0;
+		header = NULL;
+	}
+public:
+	MappedPhonebook() : data(NULL), dataSize(0), header(NULL), slots(NULL), heap(NULL) {}
+	~MappedPhonebook() {
+		unmap();
+	}
+	MappedPhonebook(const MappedPhonebook&) = delete;
+	MappedPhonebook& operator=(const MappedPhonebook&) = delete;
+
+	//writes the table file of the contacts; later duplicates of a name are skipped as HashTable does
+	static bool build(const vector<Contact>& contacts, const string& fileName, uint64_t seed) {
+		uint32_t slotBits = 1;
+		while (((uint64_t)1 << slotBits) * MAPPED_TABLE_LOAD <= contacts.size())
+			slotBits++;
+		if (slotBits > MAPPED_TABLE_MAX_SLOT_BITS)
+			return false;
+		vector<MappedTableSlot> slotArray((size_t)1 << slotBits, MappedTableSlot{ 0, 0 });
+		string heapBytes(4, '\0');
+		uint64_t count = 0;
+		for (const Contact& contact : contacts) {
+			const uint64_t h = WyNameHasher::hash(contact.firstName, contact.lastName, seed);
+			int pos = WyNameHasher::slot(h, slotArray.size());
+			bool duplicate = false;
+			for (int probe = 1; slotArray[pos].offset != 0; probe++) {
+				const char* record = heapBytes.data() + (size_t)slotArray[pos].offset * 4;
+				uint32_t length[2];
+				memcpy(length, record, 8);
+				if (slotArray[pos].tag == (uint32_t)(h >> 32) && string_view(record + 16, length[0]) == contact.firstName
+					&& string_view(record + 16 + length[0], length[1]) == contact.lastName) {
+					duplicate = true;
+					break;
+				}
+				pos = WyNameHasher::nextSlot(pos, probe, slotArray.size());
+			}
+			if (duplicate)
+				continue;
+			if (heapBytes.size() / 4 > UINT32_MAX)
+				return false; //the heap is too large for 32-bit offsets
+			slotArray[pos] = MappedTableSlot{ (uint32_t)(h >> 32), (uint32_t)(heapBytes.size() / 4) };
+			const string* fields[4] = { &contact.firstName, &contact.lastName, &contact.phoneNumber, &contact.city };
+			for (const string* field : fields) {
+				const uint32_t length = field->size();
+				heapBytes.append(reinterpret_cast<const char*>(&length), 4);
+			}
+			for (const string* field : fields)
+				heapBytes += *field;
+			heapBytes.resize((heapBytes.size() + 3) & ~(size_t)3);
+			count++;
+		}
+
+		MappedTableHeader fileHeader;
+		memset(&fileHeader, 0, sizeof(fileHeader));
+		memcpy(fileHeader.magic, MAPPED_TABLE_MAGIC, sizeof(fileHeader.magic));
+		fileHeader.version = MAPPED_TABLE_VERSION;
+		fileHeader.slotBits = slotBits;
+		fileHeader.seed = seed;
+		fileHeader.count = count;
+		fileHeader.slotOffset = sizeof(MappedTableHeader);
+		fileHeader.heapOffset = fileHeader.slotOffset + slotArray.size() * sizeof(MappedTableSlot);
+		fileHeader.heapSize = heapBytes.size();
+		ofstream outFile(fileName, ios::binary | ios::trunc);
+		if (!outFile.is_open())
+			return false;
+		outFile.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+		outFile.write(reinterpret_cast<const char*>(slotArray.data()), slotArray.size() * sizeof(MappedTableSlot));
+		outFile.write(heapBytes.data(), heapBytes.size());
+		return outFile.good();
+	}
+	//maps the table file; false if it cannot be read or is not a table file
+	bool open(const string& fileName) {
+		unmap();
+#ifdef _WIN32
+		ifstream inFile(fileName, ios::binary);
+		if (!inFile.is_open())
+			return false;
+		fileBuffer.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+		data = fileBuffer.data();
+		dataSize = fileBuffer.size();
+#else
+		int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0) {
+			void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapped != MAP_FAILED) {
+				//lookups touch one slot and one record, reading ahead would only waste page cache
+				madvise(mapped, info.st_size, MADV_RANDOM);
+				data = static_cast<const char*>(mapped);
+				dataSize = info.st_size;
+			}
+		}
+		::close(fd);
+		if (data == NULL)
+			return false;
+#endif
+		header = reinterpret_cast<const MappedTableHeader*>(data);
+		if (!validate()) {
+			unmap();
+			return false;
+		}
+		slots = reinterpret_cast<const MappedTableSlot*>(data + header->slotOffset);
+		heap = data + header->heapOffset;
+		return true;
+	}
+	bool isOpen() const {
+		return header != NULL;
+	}
+	//fields of the contact, all empty if it is not found
+	MappedContact find(string_view firstName, string_view lastName) const {
+		MappedContact contact;
+		if (!isOpen())
+			return contact;
+		const uint64_t h = WyNameHasher::hash(firstName, lastName, header->seed);
+		const int tableSize = 1 << header->slotBits;
+		int pos = WyNameHasher::slot(h, tableSize);
+		for (int probe = 1; slots[pos].offset != 0 && probe <= tableSize; probe++) {
+			if (slots[pos].tag == (uint32_t)(h >> 32) && readRecord(slots[pos].offset, contact)
+				&& contact.firstName == firstName && contact.lastName == lastName)
+				return contact;
+			pos = WyNameHasher::nextSlot(pos, probe, tableSize);
+		}
+		return MappedContact();
+	}
+	bool contains(string_view firstName, string_view lastName) const {
+		return !find(firstName, lastName).firstName.empty();
+	}
+	//getters
+	int getAllItemSize() const {
+		return isOpen() ? (int)header->count : 0;
+	}
+
+	int getTableSize() const {
+		return isOpen() ? 1 << header->slotBits : 0;
+	}
+};
@@ -0,0 +1,182 @@
+/*
+Hashing policies of the phonebook hash table.
+Written by Hagverdi Ibrahimli
+
+A policy hashes a full name once per operation and maps that hash to the slots of a table:
+	hash(firstName, lastName)      64-bit hash of the name, taking string_views so lookups need no temporary string
+	tableSize(minimum)             smallest table size the policy supports that is at least minimum
+	slot(h, tableSize)             home slot of hash h
+	nextSlot(pos, probe, tableSize) slot examined after pos on the probe-th step of the probe sequence
+DjbNameHasher is the original hash: byte-at-a-time djb2 on both names, prime table sizes, modulo reduction and
+quadratic probing. WyNameHasher reads the names 8 bytes at a time with a wyhash-style multiply-mix, uses power-of-two
+table sizes and Fibonacci (multiplicative) reduction, and probes triangularly, which visits every slot of the table.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class DjbNameHasher {
+public:
+	static uint64_t hash(string_view firstName, string_view lastName) {
+		size_t h1 = hash_string(firstName);
+		size_t h2 = hash_string(lastName);
+		// Combine the hashes using XOR and bit shifts
+		return h1 ^ (h2 << 1); //shifting h2 by 1 bit to the left is sames as multiplying by 2
+	}
+	static int tableSize(int minimum) {
+		return nextPrime(minimum);
+	}
+	static int slot(uint64_t h, int tableSize) {
+		return (size_t)h % tableSize;
+	}
+	static int nextSlot(int pos, int probe, int tableSize) {
+		pos += (probe << 1); //shifting probe by 1 bit to the left is sames as multiplying by 2
+		//moding by currentSize to avoid overflow
+		if (pos >= tableSize)
+			pos %= tableSize;
+		return pos;
+	}
+private:
+	//custom string hash for fields of the contact struct
+	static size_t hash_string(string_view s) {
+		size_t h = 5381; // Prime number as initial hash value
+		for (char c : s) {
+			h = (h * 33) ^ c; // Combine hash value with character value using multiplication and XOR
+		}
+		return h;
+	}
+
+	static int nextPrime(int n) {
+		//if n is even, make it odd
+		if (n % 2 == 0)
+			n++;
+		//find the next prime number
+		while (!isPrime(n)) {
+			n += 2;
+		}
+		return n;
+	}
+
+	static bool isPrime(int n) {
+		//check if n is a prime number
+		if (n == 2 || n == 3)
+			return true;
+		if (n == 1 || n % 2 == 0)
+			return false;
+		//check if n is divisible by odd numbers
+		for (int i = 3; i * i <= n; i += 2)
+			if (n % i == 0)
+				return false;
+		return true;
+	}
+};
+
+class WyNameHasher {
+public:
+	//the seed gives an independent hash function, e.g. the one stored in a mapped table file
+	static uint64_t hash(string_view firstName, string_view lastName, uint64_t seed = 0) {
+		//the length of each name is mixed in, so "AB" + "C" and "A" + "BC" hash differently
+		return hashBytes(lastName.data(), lastName.size(), hashBytes(firstName.data(), firstName.size(), seed));
+	}
+	//hash of a single field, for the indexes that are not keyed by the name
+	static uint64_t hash(string_view key) {
+		return hashBytes(key.data(), key.size(), 0);
+	}
+	//at least 2, so slot() shifts by less than 64 bits
+	static int tableSize(int minimum) {
+		int size = 2;
+		while (size < minimum)
+			size <<= 1;
+		return size;
+	}
+	//the top log2(tableSize) bits of h times 2^64 / golden ratio
+	static int slot(uint64_t h, int tableSize) {
+		return (int)((h * 0x9E3779B97F4A7C15ULL) >> (64 - log2(tableSize)));
+	}
+	static int nextSlot(int pos, int probe, int tableSize) {
+		return (pos + probe) & (tableSize - 1);
+	}
+private:
+	static const uint64_t P0 = 0xa0761d6478bd642fULL;
+	static const uint64_t P1 = 0xe7037ed1a0b428dbULL;
+	static const uint64_t P2 = 0x8ebc6af09c88c6e3ULL;
+
+	//full 64 x 64 -> 128 bit product, low half in a and high half in b
+	static void multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+		__uint128_t r = (__uint128_t)a * b;
+		a = (uint64_t)r;
+		b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		a = _umul128(a, b, &b);
+#else
+		uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+		uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+		uint64_t lo = t + (rm1 << 32);
+		c += lo < t;
+		a = lo;
+		b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+	}
+	static uint64_t mix(uint64_t a, uint64_t b) {
+		multiply(a, b);
+		return a ^ b;
+	}
+	static uint64_t read8(const char* p) {
+		uint64_t v;
+		memcpy(&v, p, 8);
+		return v;
+	}
+	static uint64_t read4(const char* p) {
+		uint32_t v;
+		memcpy(&v, p, 4);
+		return v;
+	}
+	//1 to 3 bytes
+	static uint64_t read3(const char* p, size_t length) {
+		return ((uint64_t)(uint8_t)p[0] << 16) | ((uint64_t)(uint8_t)p[length >> 1] << 8) | (uint8_t)p[length - 1];
+	}
+	static uint64_t hashBytes(const char* p, size_t length, uint64_t seed) {
+		seed ^= mix(seed ^ P0, P1);
+		uint64_t a, b;
+		if (length <= 16) {
+			if (length >= 4) {
+				//two overlapping 4-byte reads from each end cover 4 to 16 bytes
+				const size_t middle = (length >> 3) << 2;
+				a = (read4(p) << 32) | read4(p + middle);
+				b = (read4(p + length - 4) << 32) | read4(p + length - 4 - middle);
+			}
+			else if (length > 0) {
+				a = read3(p, length);
+				b = 0;
+			}
+			else
+				a = b = 0;
+		}
+		else {
+			size_t remaining = length;
+			for (; remaining > 16; remaining -= 16, p += 16)
+				seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+			a = read8(p + remaining - 16);
+			b = read8(p + remaining - 8);
+		}
+		a ^= P1;
+		b ^= seed;
+		multiply(a, b);
+		return mix(a ^ P0 ^ length, b ^ P2);
+	}
+	static int log2(int powerOfTwo) {
+#if defined(__GNUC__)
+		return __builtin_ctz(powerOfTwo);
+#else
+		int bits = 0;
+		while ((1 << bits) < powerOfTwo)
+			bits++;
+		return bits;
+#endif
+	}
+};
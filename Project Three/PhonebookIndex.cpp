@@ -0,0 +1,211 @@
+/*
+Implementation of the multi-key phonebook.
+Written by Hagverdi Ibrahimli
+
+Every contact is stored once, in a vector indexed by a 32-bit contact id; ids of removed contacts are reused.
+Three indexes refer to the contacts by id only:
+	name index   hash index from (firstName, lastName) to the contact, names are unique as in HashTable
+	phone index  hash index from the phone number to the contacts having it (reverse lookup / caller ID)
+	city index   hash index from the city to a posting list, a compact vector of the ids of the contacts in that city
+The indexes are updated together by insert and remove, so they always agree with the store.
+*/
+
+#define INDEX_EMPTY 0xFFFFFFFFu
+#define INDEX_DELETED 0xFFFFFFFEu
+#define INDEX_MAX_LOAD 0.7 //ratio of used (active or deleted) slots that triggers a rehash of an index
+
+//Open addressing hash index from a key to ids of records stored elsewhere. A slot holds the id and 32 bits of the key's
+//hash, so the records are only looked at when the hashes match. Several ids may share a key.
+class IdHashIndex {
+private:
+	struct Slot {
+		uint32_t id;
+		uint32_t hash;
+	};
+	vector<Slot> slots;
+	int tableBits; //log2 of the number of slots
+	int activeCount;
+	int usedCount; //active and deleted slots
+
+	/*private methods*/
+	//Fibonacci reduction of the hash to the power-of-two table
+	size_t home(uint32_t hash) const {
+		return (hash * 2654435769u) >> (32 - tableBits);
+	}
+	//doubles the index when it is really full, otherwise rebuilds it at the same size to drop the deleted slots
+	void rehash() {
+		if (activeCount * 2 > INDEX_MAX_LOAD * slots.size())
+			tableBits++;
+		vector<Slot> oldSlots((size_t)1 << tableBits, Slot{ INDEX_EMPTY, 0 });
+		oldSlots.swap(slots);
+		activeCount = usedCount = 0;
+		for (const Slot& slot : oldSlots)
+			if (slot.id < INDEX_DELETED)
+				insert(slot.id, slot.hash);
+	}
+public:
+	IdHashIndex() : slots(16, Slot{ INDEX_EMPTY, 0 }), tableBits(4), activeCount(0), usedCount(0) {}
+
+	static uint32_t shortHash(uint64_t h) {
+		return (uint32_t)(h >> 32);
+	}
+	void insert(uint32_t id, uint32_t hash) {
+		if (usedCount + 1 > INDEX_MAX_LOAD * slots.size())
+			rehash();
+		size_t pos = home(hash);
+		for (size_t probe = 1; slots[pos].id < INDEX_DELETED; probe++)
+			pos = (pos + probe) & (slots.size() - 1);
+		if (slots[pos].id == INDEX_EMPTY)
+			usedCount++;
+		slots[pos] = Slot{ id, hash };
+		activeCount++;
+	}
+	bool remove(uint32_t id, uint32_t hash) {
+		size_t pos = home(hash);
+		for (size_t probe = 1; slots[pos].id != INDEX_EMPTY; probe++) {
+			if (slots[pos].id == id) {
+				slots[pos].id = INDEX_DELETED;
+				activeCount--;
+				return true;
+			}
+			pos = (pos + probe) & (slots.size() - 1);
+		}
+		return false;
+	}
+	//calls visit(id) for every id with the hash for which matches(id) is true, until visit returns false
+	template <class Match, class Visit>
+	void forEach(uint32_t hash, Match matches, Visit visit) const {
+		size_t pos = home(hash);
+		for (size_t probe = 1; slots[pos].id != INDEX_EMPTY; probe++) {
+			if (slots[pos].id != INDEX_DELETED && slots[pos].hash == hash && matches(slots[pos].id) && !visit(slots[pos].id))
+				return;
+			pos = (pos + probe) & (slots.size() - 1);
+		}
+	}
+	//first id with the hash for which matches(id) is true, or INDEX_EMPTY
+	template <class Match>
+	uint32_t findFirst(uint32_t hash, Match matches) const {
+		uint32_t found = INDEX_EMPTY;
+		forEach(hash, matches, [&](uint32_t id) {
+			found = id;
+			return false;
+		});
+		return found;
+	}
+	int size() const {
+		return activeCount;
+	}
+};
+
+class PhonebookIndex {
+private:
+	struct CityPostings {
+		string city;
+		vector<uint32_t> ids;
+	};
+	vector<Contact> store; //contact id -> contact
+	vector<uint32_t> cityOf; //contact id -> city id, INDEX_EMPTY for a free id
+	vector<uint32_t> positionInCity; //contact id -> position of the id in the posting list of its city
+	vector<uint32_t> freeIds;
+	vector<CityPostings> cities; //city id -> posting list, cities are kept when they become empty
+	IdHashIndex byName;
+	IdHashIndex byPhone;
+	IdHashIndex byCity; //indexes city ids
+
+	/*private methods*/
+	uint32_t findId(const string& firstName, const string& lastName) const {
+		return byName.findFirst(IdHashIndex::shortHash(WyNameHasher::hash(firstName, lastName)), [&](uint32_t id) {
+			return store[id].firstName == firstName && store[id].lastName == lastName;
+		});
+	}
+	uint32_t findCity(const string& city) const {
+		return byCity.findFirst(IdHashIndex::shortHash(WyNameHasher::hash(city)), [&](uint32_t cityId) {
+			return cities[cityId].city == city;
+		});
+	}
+	uint32_t addCity(const string& city) {
+		uint32_t cityId = findCity(city);
+		if (cityId != INDEX_EMPTY)
+			return cityId;
+		cities.push_back(CityPostings{ city, vector<uint32_t>() });
+		byCity.insert(cities.size() - 1, IdHashIndex::shortHash(WyNameHasher::hash(city)));
+		return cities.size() - 1;
+	}
+public:
+	//inserting a new contact to the phonebook, names are unique
+	bool insert(const Contact& newContact) {
+		if (findId(newContact.firstName, newContact.lastName) != INDEX_EMPTY)
+			return false; // if the contact already exists, return false
+		uint32_t id;
+		if (!freeIds.empty()) {
+			id = freeIds.back();
+			freeIds.pop_back();
+			store[id] = newContact;
+		}
+		else {
+			id = store.size();
+			store.push_back(newContact);
+			cityOf.push_back(INDEX_EMPTY);
+			positionInCity.push_back(0);
+		}
+		byName.insert(id, IdHashIndex::shortHash(WyNameHasher::hash(newContact.firstName, newContact.lastName)));
+		byPhone.insert(id, IdHashIndex::shortHash(WyNameHasher::hash(newContact.phoneNumber)));
+		const uint32_t cityId = addCity(newContact.city);
+		cityOf[id] = cityId;
+		positionInCity[id] = cities[cityId].ids.size();
+		cities[cityId].ids.push_back(id);
+		return true;
+	}
+	bool remove(const string& firstName, const string& lastName) {
+		const uint32_t id = findId(firstName, lastName);
+		if (id == INDEX_EMPTY)
+			return false; //if the contact is not found, return false
+		const Contact& contact = store[id];
+		byName.remove(id, IdHashIndex::shortHash(WyNameHasher::hash(contact.firstName, contact.lastName)));
+		byPhone.remove(id, IdHashIndex::shortHash(WyNameHasher::hash(contact.phoneNumber)));
+		//the last id of the posting list takes the place of the removed one
+		vector<uint32_t>& postings = cities[cityOf[id]].ids;
+		const uint32_t moved = postings.back();
+		postings[positionInCity[id]] = moved;
+		positionInCity[moved] = positionInCity[id];
+		postings.pop_back();
+		cityOf[id] = INDEX_EMPTY;
+		store[id] = Contact();
+		freeIds.push_back(id);
+		return true;
+	}
+	//the pointers returned by the lookups stay valid until the next insert or remove
+	const Contact* find(const string& firstName, const string& lastName) const {
+		const uint32_t id = findId(firstName, lastName);
+		return id == INDEX_EMPTY ? NULL : &store[id];
+	}
+	//reverse lookup, every contact with the phone number
+	vector<const Contact*> findByPhone(const string& phoneNumber) const {
+		vector<const Contact*> found;
+		byPhone.forEach(IdHashIndex::shortHash(WyNameHasher::hash(phoneNumber)), [&](uint32_t id) {
+			return store[id].phoneNumber == phoneNumber;
+		}, [&](uint32_t id) {
+			found.push_back(&store[id]);
+			return true;
+		});
+		return found;
+	}
+	//the ids of the contacts in the city, in no particular order
+	const vector<uint32_t>& cityPostings(const string& city) const {
+		static const vector<uint32_t> none;
+		const uint32_t cityId = findCity(city);
+		return cityId == INDEX_EMPTY ? none : cities[cityId].ids;
+	}
+	vector<const Contact*> findByCity(const string& city) const {
+		vector<const Contact*> found;
+		for (uint32_t id : cityPostings(city))
+			found.push_back(&store[id]);
+		return found;
+	}
+	const Contact& contact(uint32_t id) const {
+		return store[id];
+	}
+	int getAllItemSize() const {
+		return byName.size();
+	}
+};
@@ -0,0 +1,134 @@
+/*
+Implementation of the Robin Hood hash table.
+Written by Hagverdi Ibrahimli
+
+Linear probing where every entry remembers its distance from its home slot. An insert that reaches an entry closer to
+its home than the new one is takes that slot and carries on with the displaced entry, which evens out the probe
+lengths. A lookup stops as soon as it reaches an entry closer to its home than the searched name would be.
+Removal shifts the following entries of the cluster one slot back instead of leaving a tombstone.
+*/
+
+#define ROBIN_HOOD_MAX_LOAD 0.9 //default maximum load factor before the table doubles
+
+class RobinHoodHashTable {
+private:
+	struct Entry {
+		Contact contact;
+		uint64_t hash;
+		int distance; //from the home slot, -1 for an empty slot
+		Entry() : hash(0), distance(-1) {}
+	};
+	vector<Entry> array;
+	int currentSize;
+	double maxLoadFactor;
+
+	/*private methods*/
+	size_t mask() const {
+		return array.size() - 1;
+	}
+	size_t home(uint64_t h) const {
+		return WyNameHasher::slot(h, array.size());
+	}
+	//slot of the name, or -1
+	long long findIndex(const string& firstName, const string& lastName, uint64_t h) const {
+		size_t pos = home(h);
+		for (int distance = 0; array[pos].distance >= distance; distance++) {
+			if (array[pos].hash == h && array[pos].contact.firstName == firstName && array[pos].contact.lastName == lastName)
+				return pos;
+			pos = (pos + 1) & mask();
+		}
+		return -1;
+	}
+	void place(Entry&& entry) {
+		size_t pos = home(entry.hash);
+		entry.distance = 0;
+		while (array[pos].distance >= 0) {
+			//the poorer entry, the one further from its home, keeps the slot
+			if (array[pos].distance < entry.distance)
+				swap(array[pos], entry);
+			pos = (pos + 1) & mask();
+			entry.distance++;
+		}
+		array[pos] = move(entry);
+	}
+	void rehash() {
+		vector<Entry> oldArray(array.size() * 2);
+		oldArray.swap(array);
+		for (Entry& entry : oldArray)
+			if (entry.distance >= 0)
+				place(move(entry));
+	}
+public:
+	RobinHoodHashTable() : RobinHoodHashTable(INITIAL_TABLE_SIZE, ROBIN_HOOD_MAX_LOAD) {}
+	//size is rounded up to a power of two
+	RobinHoodHashTable(int size, double maxLoadFactor)
+		: array(WyNameHasher::tableSize(size)), currentSize(0), maxLoadFactor(maxLoadFactor) {}
+
+	bool remove(const string& firstName, const string& lastName) {
+		long long index = findIndex(firstName, lastName, WyNameHasher::hash(firstName, lastName));
+		if (index < 0)
+			return false; //if the contact is not found, return false
+		//backward shift: pull the rest of the cluster one slot closer to home until an empty or a home entry
+		size_t pos = index, next = (pos + 1) & mask();
+		while (array[next].distance > 0) {
+			array[pos] = move(array[next]);
+			array[pos].distance--;
+			pos = next;
+			next = (next + 1) & mask();
+		}
+		array[pos] = Entry();
+		currentSize--;
+		return true; //if the contact is found and deleted, return true
+	}
+
+	const Contact find(const string& firstName, const string& lastName) const {
+		long long index = findIndex(firstName, lastName, WyNameHasher::hash(firstName, lastName));
+		if (index >= 0)
+			return array[index].contact;
+		return Contact(); //if the contact is not found, return an empty contact
+	}
+	//inserting a new contact to the table
+	bool insert(const Contact& newContact) {
+		uint64_t h = WyNameHasher::hash(newContact.firstName, newContact.lastName);
+		if (findIndex(newContact.firstName, newContact.lastName, h) >= 0)
+			return false; // if the contact already exists, return false
+		if (currentSize + 1 > maxLoadFactor * array.size())
+			rehash();
+		Entry entry;
+		entry.contact = newContact;
+		entry.hash = h;
+		place(move(entry));
+		currentSize++;
+		return true;
+	}
+	//probe lengths count the examined entries; a miss from a slot ends at an empty slot or a closer-to-home entry
+	HashProbeStats getProbeStats() const {
+		HashProbeStats stats = { currentSize, 0, 0, 0, 0, 0 };
+		long long hitProbes = 0, missProbes = 0;
+		for (size_t i = 0; i < array.size(); i++) {
+			if (array[i].distance >= 0) {
+				hitProbes += array[i].distance + 1;
+				stats.maxHitProbes = max(stats.maxHitProbes, array[i].distance + 1);
+			}
+			int distance = 0;
+			while (array[(i + distance) & mask()].distance >= distance)
+				distance++;
+			missProbes += distance + 1;
+		}
+		stats.averageHitProbes = currentSize > 0 ? (double)hitProbes / currentSize : 0;
+		stats.averageMissProbes = (double)missProbes / array.size();
+		return stats;
+	}
+	//getters
+	double getLoadFactor() const {
+		return ((double)currentSize / (double)array.size());
+	}
+
+	int getTableSize() const {
+		return array.size();
+	}
+
+	int getAllItemSize() const {
+		return currentSize;
+	}
+};
@@ -0,0 +1,216 @@
+/*
+Implementation of the Swiss-table style hash table.
+Written by Hagverdi Ibrahimli
+
+The table keeps a dense control-byte array next to a separate slot array of contacts.
+A control byte is EMPTY, DELETED or, for an occupied slot, the low 7 bits of the name hash.
+Lookups probe a group of 16 control bytes at a time (one SSE2 compare), so the names of a slot are only compared
+when its 7-bit fragment already matches. The number of slots is a power of two and groups are probed triangularly,
+which visits every group.
+*/
+
+#include <cstdint>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#define SWISS_GROUP_SIZE 16
+#define SWISS_MAX_LOAD 0.875 //default maximum ratio of occupied (active or deleted) slots before the table is rebuilt
+
+//Control bytes, full slots hold the 7-bit hash fragment 0..127
+#define CTRL_EMPTY ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+
+//index of the lowest set bit of a non-zero mask
+inline int lowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int index = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+class SwissHashTable {
+private:
+	vector<int8_t> ctrl;
+	vector<Contact> slots;
+	size_t groupMask; //number of groups - 1
+	int currentSize; //active slots
+	int deletedCount; //tombstones
+	double maxLoadFactor;
+
+	/*private methods*/
+	size_t capacity() const {
+		return slots.size();
+	}
+	//mixes the two name hashes into 64 bits, the high bits choose the group and the low 7 bits are the control fragment
+	uint64_t hash(const string& firstName, const string& lastName) const {
+		uint64_t h = hash_string(firstName) * 0x9E3779B97F4A7C15ULL ^ hash_string(lastName);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+	uint64_t hash_string(const string& s) const {
+		uint64_t h = 5381;
+		for (char c : s)
+			h = (h * 33) ^ c;
+		return h;
+	}
+	static int8_t fragment(uint64_t h) {
+		return (int8_t)(h & 0x7f);
+	}
+	size_t firstGroup(uint64_t h) const {
+		return (h >> 7) & groupMask;
+	}
+
+#if defined(__SSE2__) || defined(_M_X64)
+	//bit i is set if control byte i of the group equals value
+	uint32_t matchByte(size_t group, int8_t value) const {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl[group * SWISS_GROUP_SIZE]));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+	}
+	//EMPTY and DELETED are the only negative control bytes, so their sign bits are exactly the free slots
+	uint32_t matchFree(size_t group) const {
+		return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl[group * SWISS_GROUP_SIZE])));
+	}
+#else
+	uint32_t matchByte(size_t group, int8_t value) const {
+		uint32_t mask = 0;
+		for (int i = 0; i < SWISS_GROUP_SIZE; i++)
+			if (ctrl[group * SWISS_GROUP_SIZE + i] == value)
+				mask |= 1u << i;
+		return mask;
+	}
+	uint32_t matchFree(size_t group) const {
+		uint32_t mask = 0;
+		for (int i = 0; i < SWISS_GROUP_SIZE; i++)
+			if (ctrl[group * SWISS_GROUP_SIZE + i] < 0)
+				mask |= 1u << i;
+		return mask;
+	}
+#endif
+
+	//returns the slot holding the name, or -1 if it is not in the table
+	long long findIndex(const string& firstName, const string& lastName, uint64_t h) const {
+		const int8_t wanted = fragment(h);
+		size_t group = firstGroup(h);
+		for (size_t probe = 1; ; probe++) {
+			for (uint32_t mask = matchByte(group, wanted); mask != 0; mask &= mask - 1) {
+				size_t index = group * SWISS_GROUP_SIZE + lowestBit(mask);
+				if (slots[index].firstName == firstName && slots[index].lastName == lastName)
+					return index;
+			}
+			//an EMPTY slot ends every probe sequence that reaches this group
+			if (matchByte(group, CTRL_EMPTY) != 0 || probe > groupMask)
+				return -1;
+			group = (group + probe) & groupMask;
+		}
+	}
+	//first EMPTY or DELETED slot on the probe sequence of h
+	size_t findFreeSlot(uint64_t h) const {
+		size_t group = firstGroup(h);
+		for (size_t probe = 1; ; probe++) {
+			uint32_t mask = matchFree(group);
+			if (mask != 0)
+				return group * SWISS_GROUP_SIZE + lowestBit(mask);
+			group = (group + probe) & groupMask;
+		}
+	}
+	void allocate(size_t groups) {
+		ctrl.assign(groups * SWISS_GROUP_SIZE, CTRL_EMPTY);
+		slots.clear();
+		slots.resize(groups * SWISS_GROUP_SIZE);
+		groupMask = groups - 1;
+		currentSize = 0;
+		deletedCount = 0;
+	}
+	static size_t groupsFor(int size) {
+		size_t groups = 1;
+		while (groups * SWISS_GROUP_SIZE < (size_t)size)
+			groups <<= 1;
+		return groups;
+	}
+	//doubles the table when it is really full, otherwise rebuilds it at the same size to drop the tombstones
+	void rehash() {
+		vector<int8_t> oldCtrl;
+		vector<Contact> oldSlots;
+		oldCtrl.swap(ctrl);
+		oldSlots.swap(slots);
+		const bool grow = (currentSize + 1) * 2 > maxLoadFactor * oldSlots.size();
+		allocate((groupMask + 1) * (grow ? 2 : 1));
+		for (size_t i = 0; i < oldSlots.size(); i++) {
+			if (oldCtrl[i] >= 0) {
+				uint64_t h = hash(oldSlots[i].firstName, oldSlots[i].lastName);
+				size_t index = findFreeSlot(h);
+				ctrl[index] = fragment(h);
+				slots[index] = move(oldSlots[i]);
+				currentSize++;
+			}
+		}
+	}
+public:
+	SwissHashTable() : SwissHashTable(INITIAL_TABLE_SIZE, SWISS_MAX_LOAD) {}
+	//size is rounded up to a power of two number of slots (at least one group of 16)
+	SwissHashTable(int size, double maxLoadFactor) : maxLoadFactor(maxLoadFactor) {
+		allocate(groupsFor(size));
+	}
+
+	bool remove(const string& firstName, const string& lastName) {
+		long long index = findIndex(firstName, lastName, hash(firstName, lastName));
+		if (index < 0)
+			return false; //if the contact is not found, return false
+		const size_t group = index / SWISS_GROUP_SIZE;
+		//a group that still has an EMPTY slot stops every probe sequence, so the slot can become EMPTY again
+		if (matchByte(group, CTRL_EMPTY) != 0)
+			ctrl[index] = CTRL_EMPTY;
+		else {
+			ctrl[index] = CTRL_DELETED;
+			deletedCount++;
+		}
+		slots[index] = Contact();
+		currentSize--;
+		return true; //if the contact is found and deleted, return true
+	}
+
+	const Contact find(const string& firstName, const string& lastName) const {
+		long long index = findIndex(firstName, lastName, hash(firstName, lastName));
+		if (index >= 0)
+			return slots[index];
+		return Contact(); //if the contact is not found, return an empty contact
+	}
+	//inserting a new contact to the table
+	bool insert(const Contact& newContact) {
+		uint64_t h = hash(newContact.firstName, newContact.lastName);
+		if (findIndex(newContact.firstName, newContact.lastName, h) >= 0)
+			return false; // if the contact already exists, return false
+		if (currentSize + deletedCount + 1 > maxLoadFactor * capacity())
+			rehash();
+		size_t index = findFreeSlot(h);
+		if (ctrl[index] == CTRL_DELETED)
+			deletedCount--;
+		ctrl[index] = fragment(h);
+		slots[index] = newContact;
+		currentSize++;
+		return true;
+	}
+	//getters
+	double getLoadFactor() const {
+		return ((double)currentSize / (double)capacity());
+	}
+
+	int getTableSize() const {
+		return capacity();
+	}
+
+	int getAllItemSize() const {
+		return currentSize;
+	}
+};
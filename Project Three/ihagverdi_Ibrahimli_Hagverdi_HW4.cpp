@@ -11,11 +11,21 @@ description: This program reads a text file containing contact information and s
 #include <string>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <filesystem>
 using namespace std;
+#include "../Common/PhonebookLoader.cpp"
 
 #define INITIAL_TABLE_SIZE 53 //initial size of the hash table
 #define K 500 //Number of iterations to measure performace of BST and HashTable on find operation
 #define lambda 0.7 //load factor of the hash table
+#define REHASH_INTERVAL 256 //every REHASH_INTERVAL-th operation does the incremental rehash work of the ones before it
+#define MAX_DELETED_RATIO 0.2 //ratio of deleted entries to the table size that triggers a same-size cleanup rehash
+#define NAME_HASHER DjbNameHasher //hashing policy of HashTable, see NameHashers.cpp
+#include "NameHashers.cpp"
 struct Contact {
 	string firstName;
 	string lastName;
@@ -31,6 +41,17 @@ void printContact(const Contact& contact) {
 	cout << contact.firstName << " " << contact.lastName << " " << contact.phoneNumber << " " << contact.city << endl;
 }
 
+//keeps the compiler from dropping a computation whose result is otherwise unused, e.g. a timed find
+template <class T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
 //States of the hash table entries
 enum HashEntryStates {
 	EMPTY,
@@ -38,8 +59,20 @@ enum HashEntryStates {
 	ACTIVE,
 };
 
+//Probe sequence lengths of a hash table, in number of examined entries
+struct HashProbeStats {
+	int activeCount;
+	int deletedCount;
+	double averageHitProbes; //over the lookups of every stored element
+	int maxHitProbes;
+	double averageMissProbes; //over lookups starting at every position of the table
+	int cleanups; //same-size rehashes done to drop deleted entries
+};
+
 //HashTable class implemented adopting the 
-class HashTable {
+//Hasher is a hashing policy from NameHashers.cpp, it chooses the hash function, the table sizes and the probe sequence
+template <class Hasher>
+class BasicHashTable {
 private:
 	struct HashEntry {
 		Contact contact;
@@ -48,18 +81,34 @@ private:
 		HashEntry(const Contact& newContact, const HashEntryStates& newInfo) : contact(newContact), info(newInfo) {};
 	};
 	vector<HashEntry> array;
-	int currentSize;
+	int currentSize; //active elements in array and, during an incremental rehash, in oldArray
+	int deletedCount; //DELETED entries (tombstones) in array
+	int cleanups;
 	double loadFactor; //load factor is the ratio of the number of elements in the table to the table size
+	bool incrementalRehash; //spread rehashing over the following operations instead of doing it at once
+	bool verbose; //report every rehash on the console
+	vector<HashEntry> oldArray; //table being migrated into array and then released, empty when no incremental rehash is in progress
+	int migratePos; //next bucket of oldArray to migrate
+	vector<HashEntry> nextArray; //the next double-sized table, constructed a few entries per operation ahead of time
+	int nextTableSize;
+	int migrateRate; //buckets of oldArray migrated, and then entries of it released, per operation
+	int prepareRate; //entries of nextArray constructed per operation
+	int pendingOps; //operations since the last incremental rehash step
 	/*private methods*/
 	//returning the position where search for element terminates, using quadratic probing resolution to avoid the problem of primary clustering.
-	int findPosition(const string& firstName, const string& lastName) {
+	//h is the Hasher::hash of the name, computed once per operation and reused for every table that is searched.
+	//only active entries match, the search goes on past deleted ones; firstDeleted receives the first deleted entry passed, or -1
+	int findPosition(const vector<HashEntry>& table, string_view firstName, string_view lastName, uint64_t h, int* firstDeleted = NULL) {
 		int probe = 0;
-		int currentPos = hash(firstName, lastName);
-		while ((array[currentPos].contact.firstName != firstName || array[currentPos].contact.lastName != lastName) && array[currentPos].info != EMPTY) {
-			currentPos += (++probe << 1); //shifting probe by 1 bit to the left is sames as multiplying by 2
-			//moding by currentSize to avoid overflow
-			if (currentPos >= getTableSize())
-				currentPos %= getTableSize();
+		const int tableSize = table.size();
+		int currentPos = Hasher::slot(h, tableSize);
+		if (firstDeleted)
+			*firstDeleted = -1;
+		while (table[currentPos].info != EMPTY
+			&& (table[currentPos].info != ACTIVE || table[currentPos].contact.firstName != firstName || table[currentPos].contact.lastName != lastName)) {
+			if (firstDeleted && *firstDeleted < 0 && table[currentPos].info == DELETED)
+				*firstDeleted = currentPos;
+			currentPos = Hasher::nextSlot(currentPos, ++probe, tableSize);
 		}
 		return currentPos;
 	}
@@ -68,104 +117,233 @@ private:
 		return array[index].info == ACTIVE;
 	}
 
-	void rehash() {
-		vector<HashEntry> oldArray = array;
-		//create a new double-sized empty table
-		array.resize(nextPrime(2 * oldArray.size()));
-		for (HashEntry& entry : array)
-			entry.info = EMPTY;
-		//set the current size to 0
-		currentSize = 0;
-		for (HashEntry& entry : oldArray)
-			//inserting all the active elements from the old table to the new one
-			if (entry.info == ACTIVE)
-				insert(entry.contact);
+	bool isMigrating() const {
+		return migratePos < (int)oldArray.size();
 	}
-	//hashing function for the contact struct
-	int hash(const string& s1, const string& s2) {
-		size_t h1 = hash_string(s1);
-		size_t h2 = hash_string(s2);
-
-		// Combine the hashes using XOR and bit shifts
-		return (h1 ^ (h2 << 1)) % array.size(); //shifting h2 by 1 bit to the left is sames as multiplying by 2
+	//position of an active element in oldArray, or -1 if it is not there
+	int findInOldArray(string_view firstName, string_view lastName, uint64_t h) {
+		if (!isMigrating())
+			return -1;
+		int index = findPosition(oldArray, firstName, lastName, h);
+		return oldArray[index].info == ACTIVE ? index : -1;
+	}
+	//the entry a new element goes to: the first deleted entry on its probe sequence if there is one, otherwise the empty one ending it
+	int claimPosition(int emptyPos, int firstDeleted) {
+		if (firstDeleted < 0)
+			return emptyPos;
+		deletedCount--;
+		return firstDeleted;
+	}
+	//moves a contact to its place in array, the element count does not change
+	void placeEntry(Contact&& contact) {
+		int firstDeleted;
+		int index = findPosition(array, contact.firstName, contact.lastName, Hasher::hash(contact.firstName, contact.lastName), &firstDeleted);
+		index = claimPosition(index, firstDeleted);
+		array[index].contact = move(contact);
+		array[index].info = ACTIVE;
+	}
+
+	//moves all the active elements to a new empty table of newSize, which also drops the deleted entries
+	void rehash(int newSize) {
+		finishMigration();
+		vector<HashEntry> oldTable;
+		oldTable.swap(array);
+		array.resize(newSize);
+		deletedCount = 0;
+		for (HashEntry& entry : oldTable)
+			if (entry.info == ACTIVE)
+				placeEntry(move(entry.contact));
 	}
-
-	//custom string hash for fields of the contact struct
-	size_t hash_string(const string& s) {
-		size_t h = 5381; // Prime number as initial hash value
-		for (char c : s) {
-			h = (h * 33) ^ c; // Combine hash value with character value using multiplication and XOR
+	//number of entries examined by a lookup of the element at target (or, with target -1, until an empty entry) from start
+	int probeLength(int start, int target) const {
+		int probe = 0;
+		const int tableSize = array.size();
+		int currentPos = start;
+		while (currentPos != target && array[currentPos].info != EMPTY)
+			currentPos = Hasher::nextSlot(currentPos, ++probe, tableSize);
+		return probe + 1;
+	}
+	//inserts left until the load factor is reached, the fewest operations before the next rehash
+	int insertsUntilRehash() const {
+		return max(1, (int)(loadFactor * array.size()) - currentSize);
+	}
+	//reserves the next double-sized table; its entries are constructed by rehashStep, fast enough to be ready when the
+	//load factor is reached
+	void prepareNextTable() {
+		nextTableSize = Hasher::tableSize(2 * array.size());
+		nextArray.reserve(nextTableSize);
+		prepareRate = nextTableSize / insertsUntilRehash() + 1;
+	}
+	//swaps in the prepared table; rehashStep moves the old elements over in the first half of the inserts until the next
+	//rehash, then releases the old table and prepares the next one in the second half
+	void startIncrementalRehash() {
+		finishMigration();
+		nextArray.resize(nextTableSize); //constructs whatever was not prepared yet
+		oldArray.swap(array);
+		array.swap(nextArray);
+		deletedCount = 0;
+		migratePos = 0;
+		migrateRate = (int)oldArray.size() / max(1, insertsUntilRehash() / 2) + 1;
+	}
+	//rehash work called at the start of every operation. In incremental mode every REHASH_INTERVAL-th operation does the
+	//work of the operations since the last step, so that the others do none: it migrates buckets while a rehash is in
+	//progress, and afterwards releases entries of the old table and constructs entries of the next one
+	void rehashStep() {
+		if (!incrementalRehash || ++pendingOps < REHASH_INTERVAL)
+			return;
+		pendingOps = 0;
+		if (isMigrating())
+			migrateBuckets(REHASH_INTERVAL * migrateRate);
+		else {
+			releaseOldEntries(REHASH_INTERVAL * migrateRate);
+			for (int step = 0; step < REHASH_INTERVAL * prepareRate && (int)nextArray.size() < nextTableSize; step++)
+				nextArray.emplace_back();
 		}
-		return h;
 	}
-
-	size_t nextPrime(int n) {
-		//if n is even, make it odd
-		if (n % 2 == 0)
-			n++;
-		//find the next prime number
-		while (!isPrime(n)) {
-			n += 2;
+	//moves the elements of up to count buckets of oldArray to array, and prepares the next table after the last bucket
+	void migrateBuckets(int count) {
+		if (!isMigrating())
+			return;
+		for (; count > 0 && migratePos < (int)oldArray.size(); count--, migratePos++) {
+			HashEntry& entry = oldArray[migratePos];
+			if (entry.info == ACTIVE) {
+				placeEntry(move(entry.contact));
+				//a tombstone keeps the probe sequences of the elements not migrated yet intact
+				entry.info = DELETED;
+			}
 		}
-		return n;
-	}
-
-	bool isPrime(int n) {
-		//check if n is a prime number
-		if (n == 2 || n == 3)
-			return true;
-		if (n == 1 || n % 2 == 0)
-			return false;
-		//check if n is divisible by odd numbers
-		for (int i = 3; i * i <= n; i += 2)
-			if (n % i == 0)
-				return false;
-		return true;
+		if (!isMigrating())
+			prepareNextTable();
+	}
+	//destroys up to count entries of the migrated old table from its end and gives the whole pages they leave back to the
+	//system, so that neither destroying the entries nor freeing the table stalls a single operation
+	void releaseOldEntries(int count) {
+		const char* end = (const char*)(oldArray.data() + oldArray.size());
+		for (; count > 0 && !oldArray.empty(); count--)
+			oldArray.pop_back();
+		if (oldArray.empty()) {
+			vector<HashEntry>().swap(oldArray);
+			return;
+		}
+#ifndef _WIN32
+		const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+		const uintptr_t from = ((uintptr_t)(oldArray.data() + oldArray.size()) + pageSize - 1) & ~(pageSize - 1);
+		const uintptr_t to = min((uintptr_t)end + pageSize - 1, (uintptr_t)(oldArray.data() + oldArray.capacity())) & ~(pageSize - 1);
+		if (from < to)
+			madvise((void*)from, to - from, MADV_DONTNEED);
+#endif
+	}
+	//completes a migration in progress and releases the old table at once
+	void finishMigration() {
+		migrateBuckets(oldArray.size());
+		vector<HashEntry>().swap(oldArray);
 	}
-
 	void informUserAfterRehash(const int& prevTableSize, const double& prevLoadFactor) {
+		if (!verbose)
+			return;
 		cout << "rehashed..." << endl;
 		cout << "previous table size: " << prevTableSize << ", previous load factor: " << prevLoadFactor << ", new table size: " << getTableSize() << ", current unique item count : " << getAllItemSize() << ", current load factor : " << getLoadFactor() << endl;
 	}
 public:
 	//default constructor
-	HashTable() :array(INITIAL_TABLE_SIZE), loadFactor(0.5), currentSize(0) {}
-	//constructor with custom table size and custom load factor
-	HashTable(int size, double loadFactor) :array(size), loadFactor(loadFactor), currentSize(0) {}
+	BasicHashTable() :array(Hasher::tableSize(INITIAL_TABLE_SIZE)), loadFactor(0.5), currentSize(0), deletedCount(0), cleanups(0), incrementalRehash(false), verbose(true), migratePos(0), nextTableSize(0), migrateRate(1), prepareRate(1), pendingOps(0) {}
+	//constructor with custom table size and custom load factor; with incrementalRehash the table grows without stalling a single insert
+	//the size is rounded up to one the Hasher supports
+	BasicHashTable(int size, double loadFactor, bool incrementalRehash = false)
+		:array(Hasher::tableSize(size)), loadFactor(loadFactor), currentSize(0), deletedCount(0), cleanups(0), incrementalRehash(incrementalRehash), verbose(true), migratePos(0), nextTableSize(0), migrateRate(1), prepareRate(1), pendingOps(0) {
+		if (incrementalRehash)
+			prepareNextTable();
+	}
 
 	bool remove(const string& firstName, const string& lastName) {
-		int currentPos = findPosition(firstName, lastName);
+		rehashStep();
+		const uint64_t h = Hasher::hash(firstName, lastName);
+		int currentPos = findPosition(array, firstName, lastName, h);
 		if (isActive(currentPos)) {
 			array[currentPos].info = DELETED;
 			currentSize--;
+			deletedCount++;
 			return true; //if the contact is found and deleted, return true
 		}
+		int oldPos = findInOldArray(firstName, lastName, h);
+		if (oldPos >= 0) {
+			oldArray[oldPos].info = DELETED;
+			currentSize--;
+			return true;
+		}
 		return false; //if the contact is not found, return false
 	}
 
 	const Contact find(const string& firstName, const string& lastName) {
-		int index = findPosition(firstName, lastName);
-		if (isActive(index))
-			return array[index].contact;
+		const Contact* contact = lookup(firstName, lastName);
+		if (contact != NULL)
+			return *contact;
 		return Contact(); //if the contact is not found, return an empty contact
 	}
+	//pointer to the stored contact, or NULL if it is not found; nothing is copied or allocated.
+	//the pointer is only valid until the next operation on the table, which may move the contact
+	const Contact* lookup(string_view firstName, string_view lastName) {
+		rehashStep();
+		const uint64_t h = Hasher::hash(firstName, lastName);
+		int index = findPosition(array, firstName, lastName, h);
+		if (isActive(index))
+			return &array[index].contact;
+		int oldIndex = findInOldArray(firstName, lastName, h);
+		if (oldIndex >= 0)
+			return &oldArray[oldIndex].contact;
+		return NULL;
+	}
+	bool contains(string_view firstName, string_view lastName) {
+		return lookup(firstName, lastName) != NULL;
+	}
 	//inserting a new contact to the table
 	bool insert(const Contact& newContact) {
-		int index = findPosition(newContact.firstName, newContact.lastName);
+		rehashStep();
+		const uint64_t h = Hasher::hash(newContact.firstName, newContact.lastName);
+#if defined(__GNUC__)
+		//during a migration the place in array is fetched while oldArray is searched
+		if (isMigrating())
+			__builtin_prefetch(&array[Hasher::slot(h, array.size())]);
+#endif
+		if (findInOldArray(newContact.firstName, newContact.lastName, h) >= 0)
+			return false; // the contact already exists and has not been migrated yet
+		int firstDeleted;
+		int index = findPosition(array, newContact.firstName, newContact.lastName, h, &firstDeleted);
 		if (isActive(index)) {
 			return false; // if the contact already exists, return false
 		}
+		index = claimPosition(index, firstDeleted);
 		array[index] = HashEntry(newContact, ACTIVE);
 		currentSize++;
 		//rehashing if the table is half full (load factor = 0.5)
 		if (getLoadFactor() >= loadFactor) {
 			const int prevTableSize = getTableSize();
 			const double prevLoadFactor = getLoadFactor();
-			rehash();
+			if (incrementalRehash)
+				startIncrementalRehash();
+			else
+				rehash(Hasher::tableSize(2 * array.size()));
 			informUserAfterRehash(prevTableSize, prevLoadFactor);
 		}
+		//too many deleted entries lengthen every probe sequence, rebuild the table at the same size without them
+		else if (deletedCount > MAX_DELETED_RATIO * array.size()) {
+			rehash(array.size());
+			cleanups++;
+		}
 		return true;
 	}
+	//grows the table once so that count elements fit below the load factor, inserting them then never rehashes
+	void reserve(int count) {
+		const int size = Hasher::tableSize((int)(count / loadFactor) + 1);
+		if (size <= (int)array.size())
+			return;
+		rehash(size);
+		if (incrementalRehash)
+			prepareNextTable();
+	}
+	void setVerbose(bool report) {
+		verbose = report;
+	}
 	//getters
 	double getLoadFactor() {
 		return ((double)currentSize / (double)array.size());
@@ -179,9 +357,39 @@ public:
 		return currentSize;
 	}
 
+	int getDeletedCount() {
+		return deletedCount;
+	}
+	//walks the whole table, so it is meant for diagnostics only
+	HashProbeStats getProbeStats() {
+		finishMigration();
+		HashProbeStats stats = { currentSize, deletedCount, 0, 0, 0, cleanups };
+		long long hitProbes = 0, missProbes = 0;
+		for (int i = 0; i < (int)array.size(); i++) {
+			missProbes += probeLength(i, -1);
+			if (isActive(i)) {
+				int length = probeLength(Hasher::slot(Hasher::hash(array[i].contact.firstName, array[i].contact.lastName), array.size()), i);
+				hitProbes += length;
+				stats.maxHitProbes = max(stats.maxHitProbes, length);
+			}
+		}
+		stats.averageHitProbes = currentSize > 0 ? (double)hitProbes / currentSize : 0;
+		stats.averageMissProbes = (double)missProbes / array.size();
+		return stats;
+	}
+
 
 };
 
+typedef BasicHashTable<NAME_HASHER> HashTable;
+
+#include "ConcurrentHashTable.cpp"
+#include "PhonebookIndex.cpp"
+#include "SwissHashTable.cpp"
+#include "RobinHoodHashTable.cpp"
+#include "CuckooHashTable.cpp"
+#include "MappedPhonebook.cpp"
+
 //function to convert a string to upper case
 const string toUpperCase(string& my_string) {
 	for (char& c : my_string) {
@@ -207,6 +415,19 @@ bool isFirstAlphabetically(const string& string1, const string& string2) {
 	}
 	return (string1.length() < string2.length()); // string1 comes first if it is shorter
 }
+//the same order as isFirstAlphabetically(first1 + last1, first2 + last2), without building the concatenations
+bool isFirstAlphabetically(string_view first1, string_view last1, string_view first2, string_view last2) {
+	const size_t length1 = first1.size() + last1.size(), length2 = first2.size() + last2.size();
+	for (size_t i = 0; i < length1 && i < length2; i++) {
+		const char c1 = i < first1.size() ? first1[i] : last1[i - first1.size()];
+		const char c2 = i < first2.size() ? first2[i] : last2[i - first2.size()];
+		if (c1 < c2)
+			return true;
+		else if (c1 > c2)
+			return false;
+	}
+	return length1 < length2;
+}
 
 
 /*Template class implementation of the Binary search tree*/
@@ -226,7 +447,24 @@ public:
 		return findMax(root)->contactInfo;
 	}
 	const Contact find(const string& firstName, const string& lastName) const {
-		return searchByFullName(root, firstName, lastName);
+		const Contact* contact = lookup(firstName, lastName);
+		if (contact != NULL)
+			return *contact;
+		return Contact();
+	}
+	//pointer to the stored contact, or NULL if it is not found; nothing is copied or allocated.
+	//the pointer is valid until the next insert or remove
+	const Contact* lookup(string_view firstName, string_view lastName) const {
+		Node* rt = root;
+		while (rt != NULL) {
+			if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName)
+				return &rt->contactInfo;
+			rt = isFirstAlphabetically(rt->contactInfo.firstName, rt->contactInfo.lastName, firstName, lastName) ? rt->right : rt->left;
+		}
+		return NULL;
+	}
+	bool contains(string_view firstName, string_view lastName) const {
+		return lookup(firstName, lastName) != NULL;
 	}
 	bool isEmpty() const {
 		return (root == NULL);
@@ -274,7 +512,7 @@ private:
 			//is a duplicate -> don't allow
 			inserted = false;
 		}
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (newContact.firstName + newContact.lastName)))
+		else if (isFirstAlphabetically(rt->contactInfo.firstName, rt->contactInfo.lastName, newContact.firstName, newContact.lastName))
 			insert(newContact, rt->right, inserted);
 		else
 			insert(newContact, rt->left, inserted);
@@ -282,7 +520,7 @@ private:
 	void remove(const string& firstName, const string& lastName, Node*& rt, bool& removed) {
 		if (rt == NULL)
 			return;   // Item not found; do nothing
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (firstName + lastName)))
+		else if (isFirstAlphabetically(rt->contactInfo.firstName, rt->contactInfo.lastName, firstName, lastName))
 			remove(firstName, lastName, rt->right, removed);
 		else if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName) {
 			if (rt->left != NULL && rt->right != NULL) {
@@ -316,18 +554,6 @@ private:
 		return rt;
 	}
 
-	const Contact searchByFullName(Node* const& rt, const string& firstName, const string& lastName) const {
-		if (rt == NULL) {  // create a new node at the right place
-			return Contact();
-		}
-		else if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName) {
-			return rt->contactInfo;
-		}
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (firstName + lastName)))
-			return searchByFullName(rt->right, firstName, lastName);
-		else
-			return searchByFullName(rt->left, firstName, lastName);
-	}
 	void makeEmpty(Node*& rt) {
 		if (rt == NULL)
 			return;
@@ -345,26 +571,14 @@ private:
 };
 /*End of the Binary search tree class implementation*/
 
-void makeBST(BinarySearchTree<Contact>& BST, ifstream& input_file) {
-	string fname, lname, city, phoneNum;
-	while (input_file) {
-		input_file >> fname >> lname >> phoneNum >> city;
-		if (input_file) {
-			Contact newContact(toUpperCase(fname), toUpperCase(lname), phoneNum, city);
-			BST.insert(newContact);
-		}
-	}
+void makeBST(BinarySearchTree<Contact>& BST, const vector<Contact>& contacts) {
+	for (const Contact& newContact : contacts)
+		BST.insert(newContact);
 }
 
-void makeHashTable(HashTable& myHashTable, ifstream& input_file) {
-	string fname, lname, city, phoneNum;
-	while (input_file) {
-		input_file >> fname >> lname >> phoneNum >> city;
-		if (input_file) {
-			Contact newContact(toUpperCase(fname), toUpperCase(lname), phoneNum, city);
-			myHashTable.insert(newContact);
-		}
-	}
+void makeHashTable(HashTable& myHashTable, const vector<Contact>& contacts) {
+	for (const Contact& newContact : contacts)
+		myHashTable.insert(newContact);
 }
 
 
@@ -393,22 +607,17 @@ void prompt(BinarySearchTree<Contact>& BST, HashTable& HashTable) {
 			cout << "Searching an item in the phonebook  (BST) . . ." << endl;
 			cout << "Phonebook: Searching for: (" << firstName << " " << lastName << ")" << endl;
 			cout << "====================================" << endl;
+			Contact foundContact = BST.find(firstName, lastName);
+			if (!foundContact.firstName.empty()) {
+				printContact(foundContact);
+			}
+			else {
+				cout << "Name not found!" << endl;
+			}
+			//the printing above is not timed; every timed result is consumed so the loop cannot be optimized away
 			auto start = std::chrono::high_resolution_clock::now();
 			for (int i = 0; i < K; i++)
-			{
-				if (i == 0) {
-					Contact foundContact = BST.find(firstName, lastName);
-					if (!foundContact.firstName.empty()) {
-						printContact(foundContact);
-					}
-					else {
-						cout << "Name not found!" << endl;
-					}
-				}
-				else {
-					BST.find(firstName, lastName);
-				}
-			}
+				doNotOptimize(BST.lookup(firstName, lastName));
 			auto BSTTime = std::chrono::duration_cast<std::chrono::nanoseconds>
 				(std::chrono::high_resolution_clock::now() - start);
 			cout << "\nBST Search Time: " << (BSTTime.count() / K) / 1000000.0 << "\n\n"; //in milliseconds
@@ -416,22 +625,16 @@ void prompt(BinarySearchTree<Contact>& BST, HashTable& HashTable) {
 			cout << "Searching an item in the phonebook  (HashTable) . . ." << endl;
 			cout << "Phonebook: Searching for: (" << firstName << " " << lastName << ")" << endl;
 			cout << "====================================" << endl;
+			foundContact = HashTable.find(firstName, lastName);
+			if (!foundContact.firstName.empty()) {
+				printContact(foundContact);
+			}
+			else {
+				cout << "Name not found!" << endl;
+			}
 			start = std::chrono::high_resolution_clock::now();
 			for (int i = 0; i < K; i++)
-			{
-				if (i == 0) {
-					Contact foundContact = HashTable.find(firstName, lastName);
-					if (!foundContact.firstName.empty()) {
-						printContact(foundContact);
-					}
-					else {
-						cout << "Name not found!" << endl;
-					}
-				}
-				else {
-					HashTable.find(firstName, lastName);
-				}
-			}
+				doNotOptimize(HashTable.lookup(firstName, lastName));
 			auto HTTime = std::chrono::duration_cast<std::chrono::nanoseconds>
 				(std::chrono::high_resolution_clock::now() - start);
 			cout << "\nHash Table Search Time: " << (HTTime.count() / K) / 1000000.0 << "\n";
@@ -528,20 +731,23 @@ void prompt(BinarySearchTree<Contact>& BST, HashTable& HashTable) {
 }
 
 
-void run() {
+//with presize the hash table is sized for the whole file up front instead of growing through its rehashes
+void run(bool presize) {
 	string fileName;
 	cout << "Enter the file name: ";
 	getline(cin, fileName);
 
-	ifstream input_file(fileName);
-	if (!input_file.is_open()) {
+	//the file is read once with the shared loader, first and last names are upper-cased
+	PhonebookFile phonebook;
+	if (!phonebook.load(fileName, UPPERCASE_NAMES)) {
 		cerr << "Error opening file. Please try again." << endl;
 		return;
 	}
+	const vector<Contact> contacts = phonebook.contacts<Contact>();
 	// Create BST
 	BinarySearchTree<Contact> BST;
 	cout << "Loading the phonebook into a BST . . ." << endl;
-	makeBST(BST, input_file);
+	makeBST(BST, contacts);
 	cout << "Loaded the phonebook into a BST." << endl;
 	const int heightLeftSubTree = BST.heightLeftSubTree();
 	const int heightRightSubTree = BST.heightRightSubTree();
@@ -552,12 +758,11 @@ void run() {
 	cout << endl;
 	cout << "The heights of BST are for left: " << heightLeftSubTree << " and right: " << heightRightSubTree << endl;
 	// Create HashTable
-	input_file.clear();
-	input_file.seekg(0, ios::beg);
 	cout << "Loading the phonebook into a HashTable . . ." << endl;
 	HashTable myHashTable(INITIAL_TABLE_SIZE, lambda); // lambda = 0.7, initial table size = 53
-	makeHashTable(myHashTable, input_file);
-	input_file.close();
+	if (presize)
+		myHashTable.reserve(contacts.size());
+	makeHashTable(myHashTable, contacts);
 	cout << "Loaded the phonebook into a HashTable." << endl;
 	cout << "After preprocessing, the contact count is " << myHashTable.getAllItemSize() << ". Current load ratio is " << myHashTable.getLoadFactor() << endl;
 	cout << endl << endl;
@@ -565,9 +770,81 @@ void run() {
 	prompt(BST, myHashTable);
 }
 
+//HW4 --build-table <contact file> <table file> writes the contacts to a mapped table file, see MappedPhonebook.cpp
+int buildMappedTable(int argc, char* argv[]) {
+	if (argc < 4) {
+		cerr << "Usage: " << argv[0] << " --build-table <contact file> <table file>" << endl;
+		return 1;
+	}
+	PhonebookFile phonebook;
+	if (!phonebook.load(argv[2], UPPERCASE_NAMES)) {
+		cerr << "Error opening file. Please try again." << endl;
+		return 1;
+	}
+	const uint64_t seed = ((uint64_t)random_device()() << 32) | random_device()();
+	if (!MappedPhonebook::build(phonebook.contacts<Contact>(), argv[3], seed)) {
+		cerr << "Error writing the table file." << endl;
+		return 1;
+	}
+	cout << "Wrote the phonebook table " << argv[3] << endl;
+	return 0;
+}
+
+//HW4 --table <table file> searches a mapped table file in place, one name per line until an empty line
+int searchMappedTable(int argc, char* argv[]) {
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " --table <table file>" << endl;
+		return 1;
+	}
+	auto start = std::chrono::high_resolution_clock::now();
+	MappedPhonebook table;
+	if (!table.open(argv[2])) {
+		cerr << "Error opening the table file. Please try again." << endl;
+		return 1;
+	}
+	auto openTime = std::chrono::duration_cast<std::chrono::nanoseconds>
+		(std::chrono::high_resolution_clock::now() - start);
+	cout << "Opened the phonebook table with " << table.getAllItemSize() << " contacts in " << openTime.count() / 1000000.0 << endl;
+	string input, firstName, lastName;
+	while (true) {
+		cout << "Enter name to search for: ";
+		if (!getline(cin, input) || input.empty())
+			break;
+		stringstream ss(input);
+		firstName.clear();
+		lastName.clear();
+		ss >> firstName >> lastName;
+		firstName = toUpperCase(firstName);
+		lastName = toUpperCase(lastName);
+		cout << endl;
+		MappedContact found = table.find(firstName, lastName);
+		if (!found.firstName.empty())
+			printContact(found.toContact());
+		else
+			cout << "Name not found!" << endl;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < K; i++)
+			doNotOptimize(table.find(firstName, lastName));
+		auto searchTime = std::chrono::duration_cast<std::chrono::nanoseconds>
+			(std::chrono::high_resolution_clock::now() - start);
+		cout << "\nTable Search Time: " << (searchTime.count() / K) / 1000000.0 << "\n\n"; //in milliseconds
+	}
+	return 0;
+}
+
+
+#include "HashBenchmark.cpp"
 
-int main() {
-	run();
+int main(int argc, char* argv[]) {
+	//HW4 --bench <contact file> [options] runs the non-interactive benchmark, see HashBenchmark.cpp
+	if (argc > 1 && string(argv[1]) == "--bench")
+		return runHashBenchmark(argc, argv);
+	if (argc > 1 && string(argv[1]) == "--build-table")
+		return buildMappedTable(argc, argv);
+	if (argc > 1 && string(argv[1]) == "--table")
+		return searchMappedTable(argc, argv);
+	//HW4 --presize runs the interactive program with a hash table that does not rehash while loading
+	run(argc > 1 && string(argv[1]) == "--presize");
 	return 0;
 }
 
@@ -34,16 +34,32 @@ void printContacts(vector<contact>& contacts) {
 
 
 }
-bool isFirstAlphabetically(const string& string1, const string& string2) {
-	for (int i = 0; i < string1.length() && i < string2.length(); i++) {
-		if (string1[i] < string2[i]) {
-			return true; // string1 comes first
-		}
-		else if (string1[i] > string2[i]) {
-			return false; // string2 comes first
-		}
-	}
-	return (string1.length() < string2.length()); // string1 comes first if it is shorter
+void printContacts(const vector<const contact*>& contacts) {
+	for (const contact* c : contacts)
+		cout << c->firstName << " " << c->lastName << " " << c->phoneNumber << " " << c->city << endl;
+}
+//Comparator shared by every tree engine: orders contacts by firstName + lastName,
+//without building the concatenated keys. Returns <0 if the first key comes first, 0 if the names are equal, >0 otherwise.
+int compareKeys(const string& firstName1, const string& lastName1, const string& firstName2, const string& lastName2) {
+	const int length1 = firstName1.length() + lastName1.length();
+	const int length2 = firstName2.length() + lastName2.length();
+	const int split1 = firstName1.length();
+	const int split2 = firstName2.length();
+	for (int i = 0; i < length1 && i < length2; i++) {
+		char c1 = (i < split1) ? firstName1[i] : lastName1[i - split1];
+		char c2 = (i < split2) ? firstName2[i] : lastName2[i - split2];
+		if (c1 < c2) {
+			return -1; // first key comes first
+		}
+		else if (c1 > c2) {
+			return 1; // second key comes first
+		}
+	}
+	if (length1 != length2)
+		return (length1 < length2) ? -1 : 1; // the shorter key comes first
+	//same concatenated key from different names (e.g. "AB C" and "A BC"): the shorter first name comes first,
+	//so that only identical names compare equal
+	return (split1 < split2) ? -1 : ((split1 > split2) ? 1 : 0);
 }
 
 const string toUpperCase(string& my_string) {
@@ -53,6 +69,35 @@ const string toUpperCase(string& my_string) {
 	return my_string;
 }
 
+//Compares the first prefix.length() characters of the tree key (firstName + lastName) with prefix,
+//without building the concatenated key. Returns <0, 0 or >0 like string::compare.
+template <class Record>
+int compareKeyPrefix(const Record& c, const string& prefix) {
+	const size_t firstLength = c.firstName.length();
+	for (size_t i = 0; i < prefix.length(); i++) {
+		char ch;
+		if (i < firstLength)
+			ch = c.firstName[i];
+		else if (i - firstLength < c.lastName.length())
+			ch = c.lastName[i - firstLength];
+		else
+			return -1; // key is shorter than the prefix, so it comes first
+		if (ch < prefix[i])
+			return -1;
+		else if (ch > prefix[i])
+			return 1;
+	}
+	return 0;
+}
+
+//Search semantics shared by both trees: prefix of the first name, or exact first name and prefix of the last name
+template <class Record>
+bool isSearchMatch(const Record& c, const string& firstName, const string& lastName) {
+	if (lastName.empty())
+		return c.firstName.compare(0, firstName.length(), firstName) == 0;
+	return c.firstName == firstName && c.lastName.compare(0, lastName.length(), lastName) == 0;
+}
+
 bool checkTreeBalance(const int& heightLeft, const int& heightRight) {
 	if ((heightLeft - heightRight) >= 2 || (heightLeft - heightRight) <= -2)
 		return false;
@@ -60,6 +105,9 @@ bool checkTreeBalance(const int& heightLeft, const int& heightRight) {
 }
 /*End of the Utility functions*/
 
+#include "../Common/PhonebookLoader.cpp"
+#include "TreeSnapshot.cpp"
+
 
 /*Template class implementation of the Binary search tree*/
 template <class C> 
@@ -79,14 +127,20 @@ public:
 	}
 	const vector<contact> find(const string& firstName, const string& lastName) const {
 		vector<contact> matches;
-		if (lastName.empty()) {
-			searchByFirstName(root, firstName, matches);
-		}
-		else {
-			searchByFullName(root, firstName, lastName, matches);
-		}
+		forEachMatch(firstName, lastName, [&matches](const contact& c) { matches.push_back(c); });
 		return matches;
 	}
+	//Streams every match in order to visit(const contact&) without copying any contact
+	template <class Visitor>
+	void forEachMatch(const string& firstName, const string& lastName, Visitor visit) const {
+		const string keyPrefix = firstName + lastName;
+		visitMatches(root, firstName, lastName, keyPrefix, visit);
+	}
+	int countMatches(const string& firstName, const string& lastName) const {
+		int count = 0;
+		forEachMatch(firstName, lastName, [&count](const contact&) { count++; });
+		return count;
+	}
 	bool isEmpty() const {
 		return (root == NULL);
 	}
@@ -110,6 +164,18 @@ public:
 	void makeEmpty() {
 		makeEmpty(root);
 	}
+	//Writes the tree to a snapshot file, remembering which text file it was built from
+	bool saveSnapshot(const string& fileName, const string& sourceFileName) const {
+		SnapshotWriter writer;
+		appendSnapshot(root, writer);
+		return writer.writeToFile(fileName, sourceFileName);
+	}
+	//Rebuilds the exact shape of the saved tree in one pass, without any comparisons or rebalancing
+	void loadSnapshot(const TreeSnapshot& snapshot) {
+		makeEmpty(root);
+		if (snapshot.isOpen() && snapshot.nodeCount() > 0)
+			root = rehydrate(snapshot, 0);
+	}
 	bool insert(const contact& newContact) {
 		bool inserted = false;
 		insert(newContact, root, inserted);
@@ -157,7 +223,7 @@ private:
 			//is a duplicate -> don't allow
 			inserted = false;
 		}
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (newContact.firstName + newContact.lastName)))
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0)
 			insert(newContact, rt->right, inserted);
 		else
 			insert(newContact, rt->left, inserted);
@@ -165,7 +231,7 @@ private:
 	void remove(const string& firstName, const string& lastName, Node*& rt, bool& removed) {
 		if (rt == NULL)
 			return;	
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (firstName + lastName)))
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, firstName, lastName) < 0)
 			remove(firstName, lastName, rt->right, removed);
 		else if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName) {
 			if (rt->left != NULL && rt->right != NULL) {
@@ -219,25 +285,19 @@ private:
 		}
 		return rt;
 	}
-	void searchByFirstName(Node* const& rt, const string& firstName, vector<contact>& matches) const {
+	//Inorder search restricted to the key range starting with keyPrefix:
+	//keys in the left subtree are never greater than the node, keys in the right subtree are greater
+	template <class Visitor>
+	void visitMatches(Node* const& rt, const string& firstName, const string& lastName, const string& keyPrefix, Visitor& visit) const {
 		if (rt == NULL)
 			return;
-		//Inorder search
-		searchByFirstName(rt->left, firstName, matches);
-		if (rt->contactInfo.firstName.find(firstName) == 0) {
-			matches.push_back(rt->contactInfo);
-		}
-		searchByFirstName(rt->right, firstName, matches);
-	}
-	void searchByFullName(Node* const& rt, const string& firstName, const string& lastName, vector<contact>& matches) const {
-		if (rt == NULL)
-			return;
-		//inorder search
-		searchByFullName(rt->left, firstName, lastName, matches);
-		if (rt->contactInfo.firstName == firstName && rt->contactInfo.lastName.find(lastName) == 0) {
-			matches.push_back(rt->contactInfo);
-		}
-		searchByFullName(rt->right, firstName, lastName, matches);
+		int cmp = compareKeyPrefix(rt->contactInfo, keyPrefix);
+		if (cmp >= 0)
+			visitMatches(rt->left, firstName, lastName, keyPrefix, visit);
+		if (cmp == 0 && isSearchMatch(rt->contactInfo, firstName, lastName))
+			visit(rt->contactInfo);
+		if (cmp <= 0)
+			visitMatches(rt->right, firstName, lastName, keyPrefix, visit);
 	}
 	void makeEmpty(Node*& rt) {
 		if (rt == NULL)
@@ -247,6 +307,24 @@ private:
 		delete rt;
 		rt = NULL;
 	}
+	//pre-order, so a left child always directly follows its parent
+	int appendSnapshot(Node* rt, SnapshotWriter& writer) const {
+		if (rt == NULL)
+			return -1;
+		int index = writer.addNode(rt->contactInfo, 0);
+		int left = appendSnapshot(rt->left, writer);
+		int right = appendSnapshot(rt->right, writer);
+		writer.setChildren(index, left, right);
+		return index;
+	}
+	Node* rehydrate(const TreeSnapshot& snapshot, int index) const {
+		if (index < 0)
+			return NULL;
+		const contactView c = snapshot.view(index);
+		const SnapshotRecord& rec = snapshot.record(index);
+		return new Node(contact(string(c.firstName), string(c.lastName), string(c.phoneNumber), string(c.city)),
+			rehydrate(snapshot, rec.left), rehydrate(snapshot, rec.right));
+	}
 	void InOrderPrintToFile(Node* const& rt, ofstream& outFile) const {
 		if (rt == NULL) {
 			return;
@@ -287,14 +365,20 @@ public:
 	}
 	const vector<contact> find(const string& firstName, const string& lastName) const {
 		vector<contact> matches;
-		if (lastName.empty()) {
-			searchByFirstName(root, firstName, matches);
-		}
-		else {
-			searchByFullName(root, firstName, lastName, matches);
-		}
+		forEachMatch(firstName, lastName, [&matches](const contact& c) { matches.push_back(c); });
 		return matches;
 	}
+	//Streams every match in order to visit(const contact&) without copying any contact
+	template <class Visitor>
+	void forEachMatch(const string& firstName, const string& lastName, Visitor visit) const {
+		const string keyPrefix = firstName + lastName;
+		visitMatches(root, firstName, lastName, keyPrefix, visit);
+	}
+	int countMatches(const string& firstName, const string& lastName) const {
+		int count = 0;
+		forEachMatch(firstName, lastName, [&count](const contact&) { count++; });
+		return count;
+	}
 	bool isEmpty() const {
 		return (root == NULL);
 	}
@@ -317,6 +401,18 @@ public:
 	void makeEmpty() {
 		makeEmpty(root);
 	}
+	//Writes the tree to a snapshot file, remembering which text file it was built from
+	bool saveSnapshot(const string& fileName, const string& sourceFileName) const {
+		SnapshotWriter writer;
+		appendSnapshot(root, writer);
+		return writer.writeToFile(fileName, sourceFileName);
+	}
+	//Rebuilds the exact shape of the saved tree in one pass, without any comparisons or rebalancing
+	void loadSnapshot(const TreeSnapshot& snapshot) {
+		makeEmpty(root);
+		if (snapshot.isOpen() && snapshot.nodeCount() > 0)
+			root = rehydrate(snapshot, 0);
+	}
 	bool insert(const contact& newContact) {
 		bool inserted = false;
 		insert(newContact, root, inserted);
@@ -356,11 +452,11 @@ private:
 			rt = new Node(newContact, NULL, NULL);
 			inserted = true;
 		}
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (newContact.firstName + newContact.lastName))) {
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0) {
 			insert(newContact, rt->right, inserted);
 			if (height(rt->right) - height(rt->left) == 2) {
 				// height of the right subtree increased
-				if (isFirstAlphabetically((rt->right->contactInfo.firstName + rt->right->contactInfo.lastName), (newContact.firstName + newContact.lastName)))
+				if (compareKeys(rt->right->contactInfo.firstName, rt->right->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0)
 					// X was inserted to right-right subtree
 					rotateWithRightChild(rt);
 				else // X was inserted to right-left subtree
@@ -371,7 +467,7 @@ private:
 			insert(newContact, rt->left, inserted);
 			// Check if the left tree is out of balance (left subtree grew in height!)
 			if (height(rt->left) - height(rt->right) == 2) {
-				if (isFirstAlphabetically((rt->left->contactInfo.firstName + rt->left->contactInfo.lastName), (newContact.firstName + newContact.lastName)))
+				if (compareKeys(rt->left->contactInfo.firstName, rt->left->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0)
 					doubleWithLeftChild(rt);
 				else // X was inserted to the left-left subtree!
 					rotateWithLeftChild(rt);
@@ -382,7 +478,7 @@ private:
 	void remove(const string& firstName, const string& lastName, Node*& rt) {
 		if (rt == NULL)
 			return;
-		else if (isFirstAlphabetically((rt->contactInfo.firstName + rt->contactInfo.lastName), (firstName + lastName)))
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, firstName, lastName) < 0)
 			remove(firstName, lastName, rt->right);
 		else if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName) {
 			if (rt->left != NULL && rt->right != NULL) {
@@ -443,25 +539,19 @@ private:
 		}
 		return rt;
 	}
-	void searchByFirstName(Node* const& rt, const string& firstName, vector<contact>& matches) const {
+	//Inorder search restricted to the key range starting with keyPrefix:
+	//keys in the left subtree are never greater than the node, keys in the right subtree are greater
+	template <class Visitor>
+	void visitMatches(Node* const& rt, const string& firstName, const string& lastName, const string& keyPrefix, Visitor& visit) const {
 		if (rt == NULL)
 			return;
-		//Inorder search
-		searchByFirstName(rt->left, firstName, matches);
-		if ((rt->contactInfo.firstName).find((firstName)) == 0) {
-			matches.push_back(rt->contactInfo);
-		}
-		searchByFirstName(rt->right, firstName, matches);
-	}
-	void searchByFullName(Node* const& rt, const string& firstName, const string& lastName, vector<contact>& matches) const {
-		if (rt == NULL)
-			return;
-		//inorder search
-		searchByFullName(rt->left, firstName, lastName, matches);
-		if (((rt->contactInfo.firstName) == (firstName)) && ((rt->contactInfo.lastName).find((lastName)) == 0)) {
-			matches.push_back(rt->contactInfo);
-		}
-		searchByFullName(rt->right, firstName, lastName, matches);
+		int cmp = compareKeyPrefix(rt->contactInfo, keyPrefix);
+		if (cmp >= 0)
+			visitMatches(rt->left, firstName, lastName, keyPrefix, visit);
+		if (cmp == 0 && isSearchMatch(rt->contactInfo, firstName, lastName))
+			visit(rt->contactInfo);
+		if (cmp <= 0)
+			visitMatches(rt->right, firstName, lastName, keyPrefix, visit);
 	}
 	void makeEmpty(Node*& rt) {
 		if (rt == NULL)
@@ -471,6 +561,26 @@ private:
 		delete rt;
 		rt = NULL;
 	}
+	//pre-order, so a left child always directly follows its parent
+	int appendSnapshot(Node* rt, SnapshotWriter& writer) const {
+		if (rt == NULL)
+			return -1;
+		int index = writer.addNode(rt->contactInfo, rt->height); //the balance field keeps the height
+		int left = appendSnapshot(rt->left, writer);
+		int right = appendSnapshot(rt->right, writer);
+		writer.setChildren(index, left, right);
+		return index;
+	}
+	Node* rehydrate(const TreeSnapshot& snapshot, int index) const {
+		if (index < 0)
+			return NULL;
+		const contactView c = snapshot.view(index);
+		const SnapshotRecord& rec = snapshot.record(index);
+		Node* rt = new Node(contact(string(c.firstName), string(c.lastName), string(c.phoneNumber), string(c.city)),
+			rehydrate(snapshot, rec.left), rehydrate(snapshot, rec.right));
+		rt->height = rec.balance;
+		return rt;
+	}
 	void InOrderPrintToFile(Node* rt, ofstream& outFile) const {
 		if (rt == NULL) {
 			return;
@@ -543,20 +653,18 @@ private:
 };
 /*End of the AVL tree class implementation*/
 
-/*Wrap-up performance measuring functions*/
-long long searchInBST(BinarySearchTree<contact>& BST, const string & firstName, const string & lastName) {
-	auto start_time = chrono::high_resolution_clock::now();
-	vector<contact> result = BST.find(firstName, lastName);
-	auto end_time = chrono::high_resolution_clock::now();
-	printContacts(result);
-	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
-}
+#include "RedBlackTree.cpp"
+#include "Treap.cpp"
 
-long long searchInAVL(AVLtree<contact>& AVL, const string& firstName, const string& lastName) {
+/*Wrap-up performance measuring functions, shared by every tree engine*/
+template <class Tree>
+long long searchInTree(Tree& tree, const string& firstName, const string& lastName, bool printResults = true) {
+	vector<const contact*> result;
 	auto start_time = chrono::high_resolution_clock::now();
-	vector<contact> result = AVL.find(firstName, lastName);
+	tree.forEachMatch(firstName, lastName, [&result](const contact& c) { result.push_back(&c); });
 	auto end_time = chrono::high_resolution_clock::now();
-	printContacts(result);
+	if (printResults)
+		printContacts(result);
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
@@ -567,100 +675,109 @@ long long deleteFromBST(BinarySearchTree<contact>& BST, bool& success, const str
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long deleteFromAVL(AVLtree<contact>& AVL, const string& firstName, const string& lastName) {
+template <class Tree>
+long long deleteFromTree(Tree& tree, const string& firstName, const string& lastName) {
 	auto start_time = chrono::high_resolution_clock::now();
-	AVL.remove(firstName, lastName);
+	tree.remove(firstName, lastName);
 	auto end_time = chrono::high_resolution_clock::now();
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long addToBST(BinarySearchTree<contact>& BST, const contact& newContact, bool& added) {
+template <class Tree>
+long long addToTree(Tree& tree, const contact& newContact, bool& added) {
 	auto start_time = chrono::high_resolution_clock::now();
-	added = BST.insert(newContact);
+	added = tree.insert(newContact);
 	auto end_time = chrono::high_resolution_clock::now();
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long addToAVL(AVLtree<contact>& AVL, const contact& newContact, bool& added) {
+template <class Tree>
+long long InOrderPrintToFile(Tree& tree) {
 	auto start_time = chrono::high_resolution_clock::now();
-	added = AVL.insert(newContact);
+	tree.InOrderPrintToFile();
 	auto end_time = chrono::high_resolution_clock::now();
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long InOrderPrintToFile(BinarySearchTree<contact> & BST) {
+template <class Tree>
+long long PreOrderPrintToFile(Tree& tree) {
 	auto start_time = chrono::high_resolution_clock::now();
-	BST.InOrderPrintToFile();
+	tree.PreOrderPrintToFile();
 	auto end_time = chrono::high_resolution_clock::now();
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long InOrderPrintToFile(AVLtree<contact>& AVL) {
+template <class Tree>
+long long printTreeToFile(Tree& tree) {
 	auto start_time = chrono::high_resolution_clock::now();
-	AVL.InOrderPrintToFile();
+	tree.printTree();
 	auto end_time = chrono::high_resolution_clock::now();
 	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
 }
 
-long long PreOrderPrintToFile(BinarySearchTree<contact>& BST) {
+//Reads the contact file once with the shared parallel loader; names and city are upper-cased
+long long readPhonebook(const string& fileName, vector<contact>& contacts) {
 	auto start_time = chrono::high_resolution_clock::now();
-	BST.PreOrderPrintToFile();
+	PhonebookFile phonebook;
+	if (phonebook.load(fileName, UPPERCASE_NAMES_AND_CITY))
+		contacts = phonebook.contacts<contact>();
 	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+	return chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
 }
 
-long long PreOrderPrintToFile(AVLtree<contact>& AVL) {
+template <class Tree>
+long long makeTree(Tree& tree, const vector<contact>& contacts) {
 	auto start_time = chrono::high_resolution_clock::now();
-	AVL.PreOrderPrintToFile();
+	for (const contact& newContact : contacts)
+		tree.insert(newContact);
 	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+	return chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
 }
 
-long long printTreeToFile(BinarySearchTree<contact>& BST) {
+template <class Tree>
+long long loadSnapshot(Tree& tree, const TreeSnapshot& snapshot) {
 	auto start_time = chrono::high_resolution_clock::now();
-	BST.printTree();
+	tree.loadSnapshot(snapshot);
 	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+	return chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
 }
+/*End of wrap-up performance measuring functions*/
 
-long long printTreeToFile(AVLtree<contact>& AVL) {
-	auto start_time = chrono::high_resolution_clock::now();
-	AVL.printTree();
-	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+//Restores the tree from its snapshot while the text file is unchanged, otherwise builds it from text and saves a new snapshot.
+//getContacts() returns the parsed contact file, which is only read the first time a tree has to be built.
+template <class Tree, class ContactSource>
+long long loadTree(Tree& tree, const string& treeName, const string& fileName, const string& snapshotFileName, ContactSource& getContacts) {
+	long long time;
+	TreeSnapshot snapshot(snapshotFileName);
+	if (snapshot.matchesSource(fileName)) {
+		time = loadSnapshot(tree, snapshot);
+		cout << "Restored the " << treeName << " from " << snapshotFileName << endl;
+	}
+	else {
+		time = makeTree(tree, getContacts());
+		if (!tree.saveSnapshot(snapshotFileName, fileName))
+			cerr << "Could not write the snapshot " << snapshotFileName << endl;
+	}
+	cout << "Phonebook creation in " << treeName << " took " << time << " milliseconds. . ." << endl;
+	return time;
 }
 
-long long makeBST(BinarySearchTree<contact>& BST, ifstream& input_file) {
-	auto start_time = chrono::high_resolution_clock::now();
-	string fname, lname, city, phoneNum;
-	while (input_file) {
-		input_file >> fname >> lname >> phoneNum >> city;
-		if (input_file) {
-			contact newContact(toUpperCase(fname), toUpperCase(lname), phoneNum, toUpperCase(city));
-			BST.insert(newContact);
-		}
-	}
-	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
+template <class Tree>
+void reportBalance(Tree& tree, const string& treeName) {
+	const int heightLeftSubTree = tree.heightLeftSubTree();
+	const int heightRightSubTree = tree.heightRightSubTree();
+	if (checkTreeBalance(heightLeftSubTree, heightRightSubTree))
+		cout << "The " << treeName << " is balanced";
+	else
+		cout << "The " << treeName << " is not balanced";
+	cout << endl;
+	cout << "The heights of " << treeName << " are for left: " << heightLeftSubTree << " and right: " << heightRightSubTree << endl;
 }
 
-long long makeAVL(AVLtree<contact>& AVL, ifstream& input_file) {
-	auto start_time = chrono::high_resolution_clock::now();
-	string fname, lname, city, phoneNum;
-	while (input_file) {
-		input_file >> fname >> lname >> phoneNum >> city;
-		if (input_file) {
-			contact newContact(toUpperCase(fname), toUpperCase(lname), phoneNum, toUpperCase(city));
-			AVL.insert(newContact);
-		}
-	}
-	auto end_time = chrono::high_resolution_clock::now();
-	return chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
-}
-/*End of wrap-up performance measuring functions*/
+#include "Benchmark.cpp"
 
 //Function to handle all operations systematically depending on the input of user
-void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
+void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL, RedBlackTree<contact>& RB, Treap<contact>& TR) {
 	int choice;
 	do {
 		cout << "Choose which action to perform from 1 to 6: " << endl;
@@ -687,16 +804,21 @@ void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
 			cout << "Searching an item in the phonebook  (BST) . . ." << endl << endl;
 			cout << "Phonebook: Searching for: (" << firstName << " " << lastName << ")" << endl;
 			cout << "====================================" << endl;
-			long long timeBST = searchInBST(BST, firstName, lastName);
+			long long timeBST = searchInTree(BST, firstName, lastName);
 			cout << endl << endl;
 			//second AVL
 			cout << "Searching an item in the phonebook  (AVL) . . ." << endl << endl;
 			cout << "Phonebook: Searching for: (" << firstName << " " << lastName << ")" << endl;
 			cout << "====================================" << endl;
-			long long timeAVL = searchInAVL(AVL, firstName, lastName);
+			long long timeAVL = searchInTree(AVL, firstName, lastName);
 			cout << endl << endl;
+			//the balanced alternatives return the same contacts, only their timings are reported
+			long long timeRB = searchInTree(RB, firstName, lastName, false);
+			long long timeTR = searchInTree(TR, firstName, lastName, false);
 			cout << "The search in BST took " << timeBST << " nanonseconds..." << endl;
 			cout << "The search in AVL took " << timeAVL << " nanonseconds..." << endl;
+			cout << "The search in Red-Black tree took " << timeRB << " nanonseconds..." << endl;
+			cout << "The search in Treap took " << timeTR << " nanonseconds..." << endl;
 			cout << endl << endl;
 			break;
 		}
@@ -719,11 +841,11 @@ void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
 			lastName = toUpperCase(lastName);
 			city = toUpperCase(city);
 			contact newContact(firstName, lastName, phoneNumber, city);
-			//Add to BST 
-			bool success;	
+			//Add to BST
+			bool success;
 			cout << "Adding an item to the phonebook (BST) . . ." << endl;
 			cout << "====================================" << endl;
-			long long timeBST = addToBST(BST, newContact, success);
+			long long timeBST = addToTree(BST, newContact, success);
 			if (success)
 				cout << "Contact has been added successfully to the BST" << endl;
 			else
@@ -732,12 +854,19 @@ void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
 			//add to AVL
 			cout << "Adding an item to the phonebook AVL . . ." << endl;
 			cout << "====================================" << endl;
-			long long timeAVL = addToAVL(AVL, newContact, success);
+			long long timeAVL = addToTree(AVL, newContact, success);
+			bool successRB, successTR;
+			long long timeRB = addToTree(RB, newContact, successRB);
+			long long timeTR = addToTree(TR, newContact, successTR);
 			if (success) {
 				cout << "Contact has been added successfully to the AVL" << endl;
 				cout << endl << endl;
 				cout << "Adding a contact to the Binary Tree took " << timeBST << " nanoseconds. . ." << endl;
 				cout << "Adding a contact to the AVL Tree took " << timeAVL << " nanoseconds. . ." << endl;
+				if (successRB && successTR) {
+					cout << "Adding a contact to the Red-Black Tree took " << timeRB << " nanoseconds. . ." << endl;
+					cout << "Adding a contact to the Treap took " << timeTR << " nanoseconds. . ." << endl;
+				}
 			}
 			else
 			cout << "Contact not added. Duplicate exists." << endl;
@@ -758,12 +887,16 @@ void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
 			bool success;
 			//remove from BST
 			long long timeBST = deleteFromBST(BST, success, firstName, lastName);
-			//remove from AVL
-			long long timeAVL = deleteFromAVL(AVL, firstName, lastName);
+			//remove from AVL and the balanced alternatives
+			long long timeAVL = deleteFromTree(AVL, firstName, lastName);
+			long long timeRB = deleteFromTree(RB, firstName, lastName);
+			long long timeTR = deleteFromTree(TR, firstName, lastName);
 			if (success) {
 				cout << "Deleted succcessfully. . ." << endl << endl;
 				cout << "Deletion from the Binary Tree took " << timeBST << " nanoseconds. . ." << endl;
 				cout << "Deletion from the AVL Tree took " << timeAVL << " nanoseconds. . ." << endl;
+				cout << "Deletion from the Red-Black Tree took " << timeRB << " nanoseconds. . ." << endl;
+				cout << "Deletion from the Treap took " << timeTR << " nanoseconds. . ." << endl;
 			}
 			else
 				cout << "Deletion failed. Contact not found." << endl;
@@ -773,20 +906,32 @@ void prompt(BinarySearchTree<contact>& BST, AVLtree<contact>& AVL) {
 		case 4: {
 			long long timeInOrderBST = InOrderPrintToFile(BST);
 			long long timeInOrderAVL = InOrderPrintToFile(AVL);
+			long long timeInOrderRB = InOrderPrintToFile(RB);
+			long long timeInOrderTR = InOrderPrintToFile(TR);
 			long long timePreOrderBST = PreOrderPrintToFile(BST);
 			long long timePreOrderAVL = PreOrderPrintToFile(AVL);
+			long long timePreOrderRB = PreOrderPrintToFile(RB);
+			long long timePreOrderTR = PreOrderPrintToFile(TR);
 			cout << "Printing in order to file from the Binary Tree took " << timeInOrderBST <<" nanoseconds." << endl;
 			cout << "Printing in order to file from the AVL Tree took " << timeInOrderAVL << " nanoseconds." << endl;
+			cout << "Printing in order to file from the Red-Black Tree took " << timeInOrderRB << " nanoseconds." << endl;
+			cout << "Printing in order to file from the Treap took " << timeInOrderTR << " nanoseconds." << endl;
 			cout << "Printing pre order to file from the Binary Tree took " << timePreOrderBST << " nanoseconds." << endl;
 			cout << "Printing pre order to file from the AVL Tree took " << timePreOrderAVL << " nanoseconds." << endl;
+			cout << "Printing pre order to file from the Red-Black Tree took " << timePreOrderRB << " nanoseconds." << endl;
+			cout << "Printing pre order to file from the Treap took " << timePreOrderTR << " nanoseconds." << endl;
 			cout << endl << endl;
 			break;
 		}
 		case 5: {
 			long long timeBST = printTreeToFile(BST);
 			long long timeAVL = printTreeToFile(AVL);
+			long long timeRB = printTreeToFile(RB);
+			long long timeTR = printTreeToFile(TR);
 			cout << "Drawing tree to file from the Binary Tree took " << timeBST << " nanoseconds. . ." << endl;
 			cout << "Drawing tree to file from the AVL Tree took " << timeAVL << " nanoseconds. . ." << endl;
+			cout << "Drawing tree to file from the Red-Black Tree took " << timeRB << " nanoseconds. . ." << endl;
+			cout << "Drawing tree to file from the Treap took " << timeTR << " nanoseconds. . ." << endl;
 			cout << endl << endl;
 			break;
 		}
@@ -807,40 +952,46 @@ void run() {
 	ifstream input_file(fileName);
 	if (!input_file.is_open()) {
 		cerr << "Error opening file. Please try again." << endl;
-		return;	
-	}
+		return;
+	}
+	input_file.close();
+	vector<contact> contacts;
+	bool contactsRead = false;
+	auto getContacts = [&]() -> const vector<contact>& {
+		if (!contactsRead) {
+			long long timeRead = readPhonebook(fileName, contacts);
+			cout << "Reading the contact file took " << timeRead << " milliseconds. . ." << endl;
+			contactsRead = true;
+		}
+		return contacts;
+	};
+	//snapshots of the built trees are kept next to the text file and reused while it is unchanged
 	cout << "Loading the phonebook into a BST." << endl;
 	BinarySearchTree<contact> BST;
-	long long timeBST = makeBST(BST, input_file);
-	cout << "Phonebook creation in BST took " << timeBST << " milliseconds. . ." << endl;
-	const int heightLeftSubTree = BST.heightLeftSubTree();
-	const int heightRightSubTree = BST.heightRightSubTree();
-	if (checkTreeBalance(heightLeftSubTree, heightRightSubTree))
-		cout << "The BST is balanced";
-	else
-		cout << "The BST is not balanced";
-	cout << endl;
-	cout << "The heights of BST are for left: " << heightLeftSubTree << " and right: " << heightRightSubTree << endl;
+	loadTree(BST, "BST", fileName, fileName + ".bst.snap", getContacts);
+	reportBalance(BST, "BST");
 	// Create AVL
-	input_file.clear();
-	input_file.seekg(0, ios::beg);
 	cout << "Loading the phonebook into an AVL." << endl;
 	AVLtree<contact> AVL;
-	long long timeAVL = makeAVL(AVL, input_file);
-	cout << "Phonebook creation in AVL took " << timeAVL << " milliseconds. . ." << endl;
-	const int heightLeftSubTree_AVL = AVL.heightLeftSubTree();
-	const int heightRightSubTree_AVL = AVL.heightRightSubTree();
-	if (checkTreeBalance(heightLeftSubTree_AVL, heightRightSubTree_AVL))
-		cout << "The AVL is balanced";
-	else
-		cout << "The AVL is not balanced";
-	cout << endl;
-	cout << "The heights of AVL are for left: " << heightLeftSubTree_AVL << " and right: " << heightRightSubTree_AVL << endl;
+	loadTree(AVL, "AVL", fileName, fileName + ".avl.snap", getContacts);
+	reportBalance(AVL, "AVL");
+	// Create the Red-Black tree and the Treap
+	cout << "Loading the phonebook into a Red-Black tree." << endl;
+	RedBlackTree<contact> RB;
+	loadTree(RB, "Red-Black tree", fileName, fileName + ".rb.snap", getContacts);
+	reportBalance(RB, "Red-Black tree");
+	cout << "Loading the phonebook into a Treap." << endl;
+	Treap<contact> TR;
+	loadTree(TR, "Treap", fileName, fileName + ".treap.snap", getContacts);
+	reportBalance(TR, "Treap");
 	cout << endl << endl;
-	prompt(BST, AVL);
+	prompt(BST, AVL, RB, TR);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+	//AVLBST --bench <contact file> [options] runs the non-interactive benchmark, see Benchmark.cpp
+	if (argc > 1 && string(argv[1]) == "--bench")
+		return runBenchmark(argc, argv);
 	run();
 	return 0;
-}
\ No newline at end of file
+}
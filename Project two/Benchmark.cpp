@@ -0,0 +1,345 @@
+/*
+Non-interactive benchmark of the phonebook tree engines.
+Written by Hagverdi Ibrahimli
+
+Usage: AVLBST --bench <contact file> [key=value ...]
+	ops=100000        timed operations per engine
+	warmup=10000      untimed operations run first on every engine
+	mix=search:70,prefix:20,add:5,delete:5   relative weights of the operation types
+	dist=uniform      key choice, uniform or zipf
+	zipf=0.99         skew of the zipf distribution
+	prefix=2          length of the first name prefix used by prefix searches
+	seed=1            seed of the workload generator
+	format=csv        csv or json
+	engines=bst,avl,rb,treap
+Every engine runs the same generated workload on a tree built from the same contacts. Each operation is timed
+on its own, and the report gives throughput plus p50/p99/p999 latency per engine and operation type.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+
+enum BenchmarkOpType {
+	OP_SEARCH,
+	OP_PREFIX,
+	OP_ADD,
+	OP_DELETE,
+	OP_TYPE_COUNT,
+};
+
+const char* const benchmarkOpNames[OP_TYPE_COUNT] = { "search", "prefix", "add", "delete" };
+
+struct BenchmarkOp {
+	BenchmarkOpType type;
+	int key; //index into the contacts for search, prefix and delete; into the new contacts for add
+};
+
+struct BenchmarkConfig {
+	string fileName;
+	int ops = 100000;
+	int warmup = 10000;
+	double weights[OP_TYPE_COUNT] = { 70, 20, 5, 5 };
+	bool zipf = false;
+	double zipfSkew = 0.99;
+	int prefixLength = 2;
+	unsigned seed = 1;
+	bool json = false;
+	vector<string> engines = { "bst", "avl", "rb", "treap" };
+};
+
+struct BenchmarkWorkload {
+	vector<contact> newContacts; //contacts inserted by the add operations, built before timing starts
+	vector<string> prefixes; //first name prefix of every contact
+	vector<BenchmarkOp> warmupOps;
+	vector<BenchmarkOp> timedOps;
+};
+
+struct BenchmarkResult {
+	string engine;
+	string op;
+	long long count;
+	double meanNs;
+	long long p50Ns;
+	long long p99Ns;
+	long long p999Ns;
+	double throughput; //operations per second
+};
+
+//Draws contact indices either uniformly or following a zipf distribution over a random permutation of the contacts
+class KeyChooser {
+public:
+	KeyChooser(int n, bool zipf, double skew, mt19937& generator) : n(n), zipf(zipf), generator(generator) {
+		if (zipf) {
+			cdf.resize(n);
+			double sum = 0;
+			for (int i = 0; i < n; i++) {
+				sum += 1.0 / pow(i + 1.0, skew);
+				cdf[i] = sum;
+			}
+			for (double& value : cdf)
+				value /= sum;
+			//hot keys are spread over the phonebook instead of being its alphabetical start
+			rankToKey.resize(n);
+			for (int i = 0; i < n; i++)
+				rankToKey[i] = i;
+			shuffle(rankToKey.begin(), rankToKey.end(), generator);
+		}
+	}
+	int next() {
+		if (!zipf)
+			return uniform_int_distribution<int>(0, n - 1)(generator);
+		double u = uniform_real_distribution<double>(0.0, 1.0)(generator);
+		int rank = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+		return rankToKey[min(rank, n - 1)];
+	}
+private:
+	int n;
+	bool zipf;
+	mt19937& generator;
+	vector<double> cdf;
+	vector<int> rankToKey;
+};
+
+bool parseBenchmarkArgs(int argc, char* argv[], BenchmarkConfig& config) {
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " --bench <contact file> [ops=N] [warmup=N] [mix=search:W,prefix:W,add:W,delete:W]"
+			<< " [dist=uniform|zipf] [zipf=S] [prefix=L] [seed=N] [format=csv|json] [engines=bst,avl,rb,treap]" << endl;
+		return false;
+	}
+	config.fileName = argv[2];
+	for (int i = 3; i < argc; i++) {
+		string arg = argv[i];
+		size_t eq = arg.find('=');
+		if (eq == string::npos) {
+			cerr << "Invalid benchmark argument: " << arg << endl;
+			return false;
+		}
+		string key = arg.substr(0, eq);
+		string value = arg.substr(eq + 1);
+		//stoi, stod and stoul throw on a value that is not a number or does not fit
+		try {
+			if (key == "ops")
+				config.ops = stoi(value);
+			else if (key == "warmup")
+				config.warmup = stoi(value);
+			else if (key == "zipf")
+				config.zipfSkew = stod(value);
+			else if (key == "prefix")
+				config.prefixLength = stoi(value);
+			else if (key == "seed")
+				config.seed = stoul(value);
+			else if (key == "dist" && (value == "uniform" || value == "zipf"))
+				config.zipf = (value == "zipf");
+			else if (key == "format" && (value == "csv" || value == "json"))
+				config.json = (value == "json");
+			else if (key == "mix") {
+				for (double& weight : config.weights)
+					weight = 0;
+				stringstream ss(value);
+				string item;
+				while (getline(ss, item, ',')) {
+					size_t colon = item.find(':');
+					int type = 0;
+					while (type < OP_TYPE_COUNT && item.compare(0, colon, benchmarkOpNames[type]) != 0)
+						type++;
+					if (colon == string::npos || type == OP_TYPE_COUNT) {
+						cerr << "Invalid operation mix: " << value << endl;
+						return false;
+					}
+					config.weights[type] = stod(item.substr(colon + 1));
+				}
+				//discrete_distribution needs finite weights that are not negative and not all zero
+				double total = 0;
+				bool valid = true;
+				for (double weight : config.weights) {
+					if (!(weight >= 0) || isinf(weight))
+						valid = false;
+					total += weight;
+				}
+				if (!valid || !(total > 0) || isinf(total)) {
+					cerr << "Invalid operation mix: " << value << endl;
+					return false;
+				}
+			}
+			else if (key == "engines") {
+				config.engines.clear();
+				stringstream ss(value);
+				string engine;
+				while (getline(ss, engine, ','))
+					config.engines.push_back(engine);
+			}
+			else {
+				cerr << "Invalid benchmark argument: " << arg << endl;
+				return false;
+			}
+		}
+		catch (const invalid_argument&) {
+			cerr << "Invalid benchmark argument: " << arg << endl;
+			return false;
+		}
+		catch (const out_of_range&) {
+			cerr << "Invalid benchmark argument: " << arg << endl;
+			return false;
+		}
+	}
+	if (config.ops <= 0 || config.warmup < 0 || config.prefixLength <= 0) {
+		cerr << "ops, warmup and prefix must be positive." << endl;
+		return false;
+	}
+	return true;
+}
+
+BenchmarkWorkload generateWorkload(const vector<contact>& contacts, const BenchmarkConfig& config) {
+	BenchmarkWorkload workload;
+	mt19937 generator(config.seed);
+	KeyChooser chooser(contacts.size(), config.zipf, config.zipfSkew, generator);
+	discrete_distribution<int> opChooser(config.weights, config.weights + OP_TYPE_COUNT);
+	for (const contact& c : contacts)
+		workload.prefixes.push_back(c.firstName.substr(0, config.prefixLength));
+
+	for (int phase = 0; phase < 2; phase++) {
+		vector<BenchmarkOp>& ops = (phase == 0) ? workload.warmupOps : workload.timedOps;
+		const int count = (phase == 0) ? config.warmup : config.ops;
+		for (int i = 0; i < count; i++) {
+			BenchmarkOp op;
+			op.type = BenchmarkOpType(opChooser(generator));
+			if (op.type == OP_ADD) {
+				//a new name every time, so adds are never rejected as duplicates nor widen later searches
+				const contact& base = contacts[chooser.next()];
+				op.key = workload.newContacts.size();
+				workload.newContacts.push_back(contact(base.firstName, "BENCH" + to_string(op.key) + base.lastName, base.phoneNumber, base.city));
+			}
+			else
+				op.key = chooser.next();
+			ops.push_back(op);
+		}
+	}
+	return workload;
+}
+
+//Runs one operation; the returned value is folded into a checksum so that no call can be optimized away
+template <class Tree>
+long long runOp(Tree& tree, const BenchmarkOp& op, const vector<contact>& contacts, const BenchmarkWorkload& workload) {
+	switch (op.type) {
+	case OP_SEARCH:
+		return tree.countMatches(contacts[op.key].firstName, contacts[op.key].lastName);
+	case OP_PREFIX:
+		return tree.countMatches(workload.prefixes[op.key], "");
+	case OP_ADD:
+		return tree.insert(workload.newContacts[op.key]);
+	case OP_DELETE:
+		tree.remove(contacts[op.key].firstName, contacts[op.key].lastName);
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+long long percentile(const vector<long long>& sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t index = (size_t)ceil(p * sorted.size());
+	return sorted[index == 0 ? 0 : min(index, sorted.size()) - 1];
+}
+
+template <class Tree>
+void benchmarkEngine(const string& engine, const vector<contact>& contacts, const BenchmarkWorkload& workload,
+	vector<BenchmarkResult>& results, long long& checksum) {
+	Tree tree;
+	for (const contact& c : contacts)
+		tree.insert(c);
+	for (const BenchmarkOp& op : workload.warmupOps)
+		checksum += runOp(tree, op, contacts, workload);
+
+	vector<long long> latencies[OP_TYPE_COUNT];
+	auto start_time = chrono::steady_clock::now();
+	for (const BenchmarkOp& op : workload.timedOps) {
+		auto op_start = chrono::steady_clock::now();
+		checksum += runOp(tree, op, contacts, workload);
+		auto op_end = chrono::steady_clock::now();
+		latencies[op.type].push_back(chrono::duration_cast<chrono::nanoseconds>(op_end - op_start).count());
+	}
+	auto end_time = chrono::steady_clock::now();
+	double seconds = chrono::duration<double>(end_time - start_time).count();
+
+	long long total = 0;
+	for (int type = 0; type < OP_TYPE_COUNT; type++) {
+		vector<long long>& samples = latencies[type];
+		if (samples.empty())
+			continue;
+		sort(samples.begin(), samples.end());
+		long long sum = 0;
+		for (long long sample : samples)
+			sum += sample;
+		total += sum;
+		results.push_back({ engine, benchmarkOpNames[type], (long long)samples.size(), (double)sum / samples.size(),
+			percentile(samples, 0.50), percentile(samples, 0.99), percentile(samples, 0.999), samples.size() * 1e9 / sum });
+	}
+	//overall row: throughput of the whole mix, latencies over every operation
+	vector<long long> all;
+	for (const vector<long long>& samples : latencies)
+		all.insert(all.end(), samples.begin(), samples.end());
+	sort(all.begin(), all.end());
+	results.push_back({ engine, "all", (long long)all.size(), (double)total / all.size(),
+		percentile(all, 0.50), percentile(all, 0.99), percentile(all, 0.999), all.size() / seconds });
+}
+
+void printBenchmarkResults(const vector<BenchmarkResult>& results, const BenchmarkConfig& config, long long checksum) {
+	if (config.json) {
+		cout << "{\"file\": \"" << config.fileName << "\", \"ops\": " << config.ops << ", \"warmup\": " << config.warmup
+			<< ", \"dist\": \"" << (config.zipf ? "zipf" : "uniform") << "\", \"checksum\": " << checksum << ", \"results\": [" << endl;
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchmarkResult& r = results[i];
+			cout << "  {\"engine\": \"" << r.engine << "\", \"op\": \"" << r.op << "\", \"count\": " << r.count
+				<< ", \"mean_ns\": " << r.meanNs << ", \"p50_ns\": " << r.p50Ns << ", \"p99_ns\": " << r.p99Ns
+				<< ", \"p999_ns\": " << r.p999Ns << ", \"ops_per_sec\": " << r.throughput << "}"
+				<< (i + 1 < results.size() ? "," : "") << endl;
+		}
+		cout << "]}" << endl;
+	}
+	else {
+		cout << "engine,op,count,mean_ns,p50_ns,p99_ns,p999_ns,ops_per_sec" << endl;
+		for (const BenchmarkResult& r : results)
+			cout << r.engine << "," << r.op << "," << r.count << "," << r.meanNs << "," << r.p50Ns << ","
+				<< r.p99Ns << "," << r.p999Ns << "," << r.throughput << endl;
+		cerr << "checksum: " << checksum << endl;
+	}
+}
+
+int runBenchmark(int argc, char* argv[]) {
+	BenchmarkConfig config;
+	if (!parseBenchmarkArgs(argc, argv, config))
+		return 1;
+	PhonebookFile phonebook;
+	if (!phonebook.load(config.fileName, UPPERCASE_NAMES_AND_CITY)) {
+		cerr << "Error opening file. Please try again." << endl;
+		return 1;
+	}
+	const vector<contact> contacts = phonebook.contacts<contact>();
+	if (contacts.empty()) {
+		cerr << "The contact file is empty." << endl;
+		return 1;
+	}
+	const BenchmarkWorkload workload = generateWorkload(contacts, config);
+
+	vector<BenchmarkResult> results;
+	long long checksum = 0;
+	for (const string& engine : config.engines) {
+		if (engine == "bst")
+			benchmarkEngine<BinarySearchTree<contact>>(engine, contacts, workload, results, checksum);
+		else if (engine == "avl")
+			benchmarkEngine<AVLtree<contact>>(engine, contacts, workload, results, checksum);
+		else if (engine == "rb")
+			benchmarkEngine<RedBlackTree<contact>>(engine, contacts, workload, results, checksum);
+		else if (engine == "treap")
+			benchmarkEngine<Treap<contact>>(engine, contacts, workload, results, checksum);
+		else {
+			cerr << "Unknown engine: " << engine << endl;
+			return 1;
+		}
+	}
+	printBenchmarkResults(results, config, checksum);
+	return 0;
+}
@@ -0,0 +1,423 @@
+/*
+Implementation of the Red-Black tree phonebook engine.
+Written by Hagverdi Ibrahimli
+Same public interface as the AVL tree; insertions need at most two rotations and deletions at most three.
+*/
+
+/*Template class implementation of the Red-Black tree*/
+template <class C>
+class RedBlackTree
+{
+public:
+	explicit RedBlackTree() : root(NULL) {}
+	~RedBlackTree() {
+		makeEmpty(root);
+	}
+	const contact& findMin() const {
+		return findMin(root)->contactInfo;
+	}
+	const contact& findMax() const {
+		return findMax(root)->contactInfo;
+	}
+	const vector<contact> find(const string& firstName, const string& lastName) const {
+		vector<contact> matches;
+		forEachMatch(firstName, lastName, [&matches](const contact& c) { matches.push_back(c); });
+		return matches;
+	}
+	//Streams every match in order to visit(const contact&) without copying any contact
+	template <class Visitor>
+	void forEachMatch(const string& firstName, const string& lastName, Visitor visit) const {
+		const string keyPrefix = firstName + lastName;
+		visitMatches(root, firstName, lastName, keyPrefix, visit);
+	}
+	int countMatches(const string& firstName, const string& lastName) const {
+		int count = 0;
+		forEachMatch(firstName, lastName, [&count](const contact&) { count++; });
+		return count;
+	}
+	bool isEmpty() const {
+		return (root == NULL);
+	}
+	void InOrderPrintToFile() const {
+		ofstream outFile("phonebookInOrderRB.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			InOrderPrintToFile(root, outFile);
+		outFile.close();
+	}
+	void PreOrderPrintToFile() const {
+		ofstream outFile("phonebookPreOrderRB.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			PreOrderPrintToFile(root, outFile);
+		outFile.close();
+	}
+	void makeEmpty() {
+		makeEmpty(root);
+	}
+	//Writes the tree to a snapshot file, remembering which text file it was built from
+	bool saveSnapshot(const string& fileName, const string& sourceFileName) const {
+		SnapshotWriter writer;
+		appendSnapshot(root, writer);
+		return writer.writeToFile(fileName, sourceFileName);
+	}
+	//Rebuilds the exact shape and colors of the saved tree in one pass
+	void loadSnapshot(const TreeSnapshot& snapshot) {
+		makeEmpty(root);
+		if (snapshot.isOpen() && snapshot.nodeCount() > 0)
+			root = rehydrate(snapshot, 0, NULL);
+	}
+	bool insert(const contact& newContact) {
+		Node* parent = NULL;
+		Node* curr = root;
+		bool goRight = false;
+		while (curr != NULL) {
+			if (newContact.firstName == curr->contactInfo.firstName && newContact.lastName == curr->contactInfo.lastName)
+				return false; //is a duplicate -> don't allow
+			parent = curr;
+			goRight = compareKeys(curr->contactInfo.firstName, curr->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0;
+			curr = goRight ? curr->right : curr->left;
+		}
+		Node* node = new Node(newContact, NULL, NULL, parent, RED);
+		if (parent == NULL)
+			root = node;
+		else if (goRight)
+			parent->right = node;
+		else
+			parent->left = node;
+		insertFixup(node);
+		return true;
+	}
+	void remove(const string& firstName, const string& lastName) {
+		Node* z = findNode(firstName, lastName);
+		if (z == NULL)
+			return;
+		Node* y = z;
+		Color removedColor = y->color;
+		Node* x;
+		Node* xParent;
+		if (z->left == NULL) {
+			x = z->right;
+			xParent = z->parent;
+			transplant(z, z->right);
+		}
+		else if (z->right == NULL) {
+			x = z->left;
+			xParent = z->parent;
+			transplant(z, z->left);
+		}
+		else {
+			//it has two children, the successor takes its place
+			y = findMin(z->right);
+			removedColor = y->color;
+			x = y->right;
+			if (y->parent == z)
+				xParent = y;
+			else {
+				xParent = y->parent;
+				transplant(y, y->right);
+				y->right = z->right;
+				y->right->parent = y;
+			}
+			transplant(z, y);
+			y->left = z->left;
+			y->left->parent = y;
+			y->color = z->color;
+		}
+		delete z;
+		if (removedColor == BLACK)
+			removeFixup(x, xParent);
+	}
+	int heightLeftSubTree() {
+		return height(root->left);
+	}
+	int heightRightSubTree() {
+		return height(root->right);
+	}
+	void printTree() const {
+		ofstream outFile("phonebookTreeRB.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			printTree(root, "", false, outFile);
+		outFile.close();
+	}
+private:
+	enum Color {
+		RED,
+		BLACK,
+	};
+	struct Node
+	{
+		C contactInfo;
+		Node* left;
+		Node* right;
+		Node* parent;
+		Color color;
+		Node(const contact& contact,
+			Node* lt, Node* rt, Node* pt, Color c)
+			: contactInfo(contact), left(lt), right(rt), parent(pt), color(c) { }
+	};
+	Node* root;
+
+	bool isRed(Node* node) const {
+		return node != NULL && node->color == RED;
+	}
+	Node* findNode(const string& firstName, const string& lastName) const {
+		Node* curr = root;
+		while (curr != NULL) {
+			if (firstName == curr->contactInfo.firstName && lastName == curr->contactInfo.lastName)
+				return curr;
+			if (compareKeys(curr->contactInfo.firstName, curr->contactInfo.lastName, firstName, lastName) < 0)
+				curr = curr->right;
+			else
+				curr = curr->left;
+		}
+		return NULL;
+	}
+	//Red-Black manipulations
+	void rotateLeft(Node* x) {
+		Node* y = x->right;
+		x->right = y->left;
+		if (y->left != NULL)
+			y->left->parent = x;
+		y->parent = x->parent;
+		if (x->parent == NULL)
+			root = y;
+		else if (x == x->parent->left)
+			x->parent->left = y;
+		else
+			x->parent->right = y;
+		y->left = x;
+		x->parent = y;
+	}
+	void rotateRight(Node* x) {
+		Node* y = x->left;
+		x->left = y->right;
+		if (y->right != NULL)
+			y->right->parent = x;
+		y->parent = x->parent;
+		if (x->parent == NULL)
+			root = y;
+		else if (x == x->parent->right)
+			x->parent->right = y;
+		else
+			x->parent->left = y;
+		y->right = x;
+		x->parent = y;
+	}
+	//replaces the subtree rooted at u with the subtree rooted at v
+	void transplant(Node* u, Node* v) {
+		if (u->parent == NULL)
+			root = v;
+		else if (u == u->parent->left)
+			u->parent->left = v;
+		else
+			u->parent->right = v;
+		if (v != NULL)
+			v->parent = u->parent;
+	}
+	void insertFixup(Node* z) {
+		while (isRed(z->parent)) {
+			Node* grandParent = z->parent->parent; //exists, since the root is always black
+			if (z->parent == grandParent->left) {
+				Node* uncle = grandParent->right;
+				if (isRed(uncle)) {
+					// recolor and continue from the grandparent
+					z->parent->color = BLACK;
+					uncle->color = BLACK;
+					grandParent->color = RED;
+					z = grandParent;
+				}
+				else {
+					if (z == z->parent->right) {
+						// left-right case, turn it into left-left
+						z = z->parent;
+						rotateLeft(z);
+					}
+					z->parent->color = BLACK;
+					grandParent->color = RED;
+					rotateRight(grandParent);
+				}
+			}
+			else {
+				Node* uncle = grandParent->left;
+				if (isRed(uncle)) {
+					z->parent->color = BLACK;
+					uncle->color = BLACK;
+					grandParent->color = RED;
+					z = grandParent;
+				}
+				else {
+					if (z == z->parent->left) {
+						// right-left case, turn it into right-right
+						z = z->parent;
+						rotateRight(z);
+					}
+					z->parent->color = BLACK;
+					grandParent->color = RED;
+					rotateLeft(grandParent);
+				}
+			}
+		}
+		root->color = BLACK;
+	}
+	//x carries an extra black; it may be NULL, so its parent is tracked separately
+	void removeFixup(Node* x, Node* parent) {
+		while (x != root && !isRed(x)) {
+			if (x == parent->left) {
+				Node* sibling = parent->right;
+				if (isRed(sibling)) {
+					sibling->color = BLACK;
+					parent->color = RED;
+					rotateLeft(parent);
+					sibling = parent->right;
+				}
+				if (!isRed(sibling->left) && !isRed(sibling->right)) {
+					sibling->color = RED;
+					x = parent;
+					parent = x->parent;
+				}
+				else {
+					if (!isRed(sibling->right)) {
+						sibling->left->color = BLACK;
+						sibling->color = RED;
+						rotateRight(sibling);
+						sibling = parent->right;
+					}
+					sibling->color = parent->color;
+					parent->color = BLACK;
+					sibling->right->color = BLACK;
+					rotateLeft(parent);
+					x = root;
+				}
+			}
+			else {
+				Node* sibling = parent->left;
+				if (isRed(sibling)) {
+					sibling->color = BLACK;
+					parent->color = RED;
+					rotateRight(parent);
+					sibling = parent->left;
+				}
+				if (!isRed(sibling->left) && !isRed(sibling->right)) {
+					sibling->color = RED;
+					x = parent;
+					parent = x->parent;
+				}
+				else {
+					if (!isRed(sibling->left)) {
+						sibling->right->color = BLACK;
+						sibling->color = RED;
+						rotateLeft(sibling);
+						sibling = parent->left;
+					}
+					sibling->color = parent->color;
+					parent->color = BLACK;
+					sibling->left->color = BLACK;
+					rotateRight(parent);
+					x = root;
+				}
+			}
+		}
+		if (x != NULL)
+			x->color = BLACK;
+	}
+	Node* findMin(Node* rt) const {
+		while (rt != NULL && rt->left != NULL) {
+			rt = rt->left;
+		}
+		return rt;
+	}
+	Node* findMax(Node* rt) const {
+		while (rt != NULL && rt->right != NULL) {
+			rt = rt->right;
+		}
+		return rt;
+	}
+	//Inorder search restricted to the key range starting with keyPrefix
+	template <class Visitor>
+	void visitMatches(Node* const& rt, const string& firstName, const string& lastName, const string& keyPrefix, Visitor& visit) const {
+		if (rt == NULL)
+			return;
+		int cmp = compareKeyPrefix(rt->contactInfo, keyPrefix);
+		if (cmp >= 0)
+			visitMatches(rt->left, firstName, lastName, keyPrefix, visit);
+		if (cmp == 0 && isSearchMatch(rt->contactInfo, firstName, lastName))
+			visit(rt->contactInfo);
+		if (cmp <= 0)
+			visitMatches(rt->right, firstName, lastName, keyPrefix, visit);
+	}
+	void makeEmpty(Node*& rt) {
+		if (rt == NULL)
+			return;
+		makeEmpty(rt->left);
+		makeEmpty(rt->right);
+		delete rt;
+		rt = NULL;
+	}
+	//pre-order, the color is kept in the balance field of the record
+	int appendSnapshot(Node* rt, SnapshotWriter& writer) const {
+		if (rt == NULL)
+			return -1;
+		int index = writer.addNode(rt->contactInfo, rt->color);
+		int left = appendSnapshot(rt->left, writer);
+		int right = appendSnapshot(rt->right, writer);
+		writer.setChildren(index, left, right);
+		return index;
+	}
+	Node* rehydrate(const TreeSnapshot& snapshot, int index, Node* parent) const {
+		if (index < 0)
+			return NULL;
+		const contactView c = snapshot.view(index);
+		const SnapshotRecord& rec = snapshot.record(index);
+		Node* rt = new Node(contact(string(c.firstName), string(c.lastName), string(c.phoneNumber), string(c.city)),
+			NULL, NULL, parent, rec.balance == RED ? RED : BLACK);
+		rt->left = rehydrate(snapshot, rec.left, rt);
+		rt->right = rehydrate(snapshot, rec.right, rt);
+		return rt;
+	}
+	void InOrderPrintToFile(Node* rt, ofstream& outFile) const {
+		if (rt == NULL) {
+			return;
+		}
+		InOrderPrintToFile(rt->left, outFile);
+		outFile << rt->contactInfo.firstName << " " << rt->contactInfo.lastName << " " << rt->contactInfo.phoneNumber << " " << rt->contactInfo.city << endl;
+		InOrderPrintToFile(rt->right, outFile);
+	}
+	void PreOrderPrintToFile(Node* rt, ofstream& outFile) const {
+		if (rt == NULL) {
+			return;
+		}
+		outFile << rt->contactInfo.firstName << " " << rt->contactInfo.lastName << " " << rt->contactInfo.phoneNumber << " " << rt->contactInfo.city << endl;
+		PreOrderPrintToFile(rt->left, outFile);
+		PreOrderPrintToFile(rt->right, outFile);
+	}
+	int height(Node* rt) const {
+		if (rt == NULL)
+			return -1;
+		return max(height(rt->left), height(rt->right)) + 1;
+	}
+	void printTree(Node* const& curr, string indent, bool last, ofstream& outFile) const {
+		if (curr == NULL)
+			return;
+
+		outFile << indent;
+		if (last) {
+			outFile << "|__";
+			indent += "   ";
+		}
+		else {
+			outFile << "|--";
+			indent += "|  ";
+		}
+
+		outFile << curr->contactInfo.firstName << " " << curr->contactInfo.lastName << endl;
+
+		printTree(curr->left, indent, curr->right == NULL, outFile);
+		printTree(curr->right, indent, true, outFile);
+	}
+};
+/*End of the Red-Black tree class implementation*/
@@ -0,0 +1,269 @@
+/*
+Implementation of the Treap phonebook engine.
+Written by Hagverdi Ibrahimli
+Same public interface as the AVL tree. Nodes are kept in key order and in heap order of random priorities,
+so the tree is balanced in expectation and every update only rotates along a single path.
+*/
+
+#include <random>
+
+#define TREAP_SEED 20230429 //fixed seed so that runs are reproducible
+
+/*Template class implementation of the Treap*/
+template <class C>
+class Treap
+{
+public:
+	explicit Treap() : root(NULL), generator(TREAP_SEED) {}
+	~Treap() {
+		makeEmpty(root);
+	}
+	const contact& findMin() const {
+		return findMin(root)->contactInfo;
+	}
+	const contact& findMax() const {
+		return findMax(root)->contactInfo;
+	}
+	const vector<contact> find(const string& firstName, const string& lastName) const {
+		vector<contact> matches;
+		forEachMatch(firstName, lastName, [&matches](const contact& c) { matches.push_back(c); });
+		return matches;
+	}
+	//Streams every match in order to visit(const contact&) without copying any contact
+	template <class Visitor>
+	void forEachMatch(const string& firstName, const string& lastName, Visitor visit) const {
+		const string keyPrefix = firstName + lastName;
+		visitMatches(root, firstName, lastName, keyPrefix, visit);
+	}
+	int countMatches(const string& firstName, const string& lastName) const {
+		int count = 0;
+		forEachMatch(firstName, lastName, [&count](const contact&) { count++; });
+		return count;
+	}
+	bool isEmpty() const {
+		return (root == NULL);
+	}
+	void InOrderPrintToFile() const {
+		ofstream outFile("phonebookInOrderTreap.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			InOrderPrintToFile(root, outFile);
+		outFile.close();
+	}
+	void PreOrderPrintToFile() const {
+		ofstream outFile("phonebookPreOrderTreap.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			PreOrderPrintToFile(root, outFile);
+		outFile.close();
+	}
+	void makeEmpty() {
+		makeEmpty(root);
+	}
+	//Writes the tree to a snapshot file, remembering which text file it was built from
+	bool saveSnapshot(const string& fileName, const string& sourceFileName) const {
+		SnapshotWriter writer;
+		appendSnapshot(root, writer);
+		return writer.writeToFile(fileName, sourceFileName);
+	}
+	//Rebuilds the exact shape and priorities of the saved tree in one pass
+	void loadSnapshot(const TreeSnapshot& snapshot) {
+		makeEmpty(root);
+		if (snapshot.isOpen() && snapshot.nodeCount() > 0)
+			root = rehydrate(snapshot, 0);
+	}
+	bool insert(const contact& newContact) {
+		bool inserted = false;
+		insert(newContact, root, inserted);
+		return inserted;
+	}
+	void remove(const string& firstName, const string& lastName) {
+		remove(firstName, lastName, root);
+	}
+	int heightLeftSubTree() {
+		return height(root->left);
+	}
+	int heightRightSubTree() {
+		return height(root->right);
+	}
+	void printTree() const {
+		ofstream outFile("phonebookTreeTreap.txt");
+		if (!outFile.is_open())
+			cerr << "Could not create and open the file." << endl;
+		else
+			printTree(root, "", false, outFile);
+		outFile.close();
+	}
+private:
+	struct Node
+	{
+		C contactInfo;
+		Node* left;
+		Node* right;
+		int priority;
+		Node(const contact& contact,
+			Node* lt, Node* rt, int pr)
+			: contactInfo(contact), left(lt), right(rt), priority(pr) { }
+	};
+	Node* root;
+	mt19937 generator;
+
+	int randomPriority() {
+		return generator() & 0x7fffffff;
+	}
+	void insert(const contact& newContact, Node*& rt, bool& inserted) {
+		if (rt == NULL) {
+			rt = new Node(newContact, NULL, NULL, randomPriority());
+			inserted = true;
+		}
+		else if (newContact.firstName == rt->contactInfo.firstName && newContact.lastName == rt->contactInfo.lastName) {
+			//is a duplicate -> don't allow
+			inserted = false;
+		}
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, newContact.firstName, newContact.lastName) < 0) {
+			insert(newContact, rt->right, inserted);
+			// restore the heap order on the way up
+			if (rt->right->priority > rt->priority)
+				rotateWithRightChild(rt);
+		}
+		else {
+			insert(newContact, rt->left, inserted);
+			if (rt->left->priority > rt->priority)
+				rotateWithLeftChild(rt);
+		}
+	}
+	void remove(const string& firstName, const string& lastName, Node*& rt) {
+		if (rt == NULL)
+			return;
+		else if (firstName == rt->contactInfo.firstName && lastName == rt->contactInfo.lastName) {
+			if (rt->left != NULL && rt->right != NULL) {
+				//rotate the child with the higher priority up and keep pushing the node down
+				if (rt->left->priority > rt->right->priority) {
+					rotateWithLeftChild(rt);
+					remove(firstName, lastName, rt->right);
+				}
+				else {
+					rotateWithRightChild(rt);
+					remove(firstName, lastName, rt->left);
+				}
+			}
+			else {
+				//it has either one child or no children
+				Node* temp = rt;
+				rt = (rt->left == NULL) ? rt->right : rt->left;
+				delete temp;
+			}
+		}
+		else if (compareKeys(rt->contactInfo.firstName, rt->contactInfo.lastName, firstName, lastName) < 0)
+			remove(firstName, lastName, rt->right);
+		else
+			remove(firstName, lastName, rt->left);
+	}
+	Node* findMin(Node* rt) const {
+		while (rt != NULL && rt->left != NULL) {
+			rt = rt->left;
+		}
+		return rt;
+	}
+	Node* findMax(Node* rt) const {
+		while (rt != NULL && rt->right != NULL) {
+			rt = rt->right;
+		}
+		return rt;
+	}
+	//Inorder search restricted to the key range starting with keyPrefix
+	template <class Visitor>
+	void visitMatches(Node* const& rt, const string& firstName, const string& lastName, const string& keyPrefix, Visitor& visit) const {
+		if (rt == NULL)
+			return;
+		int cmp = compareKeyPrefix(rt->contactInfo, keyPrefix);
+		if (cmp >= 0)
+			visitMatches(rt->left, firstName, lastName, keyPrefix, visit);
+		if (cmp == 0 && isSearchMatch(rt->contactInfo, firstName, lastName))
+			visit(rt->contactInfo);
+		if (cmp <= 0)
+			visitMatches(rt->right, firstName, lastName, keyPrefix, visit);
+	}
+	void makeEmpty(Node*& rt) {
+		if (rt == NULL)
+			return;
+		makeEmpty(rt->left);
+		makeEmpty(rt->right);
+		delete rt;
+		rt = NULL;
+	}
+	//pre-order, the priority is kept in the balance field of the record
+	int appendSnapshot(Node* rt, SnapshotWriter& writer) const {
+		if (rt == NULL)
+			return -1;
+		int index = writer.addNode(rt->contactInfo, rt->priority);
+		int left = appendSnapshot(rt->left, writer);
+		int right = appendSnapshot(rt->right, writer);
+		writer.setChildren(index, left, right);
+		return index;
+	}
+	Node* rehydrate(const TreeSnapshot& snapshot, int index) const {
+		if (index < 0)
+			return NULL;
+		const contactView c = snapshot.view(index);
+		const SnapshotRecord& rec = snapshot.record(index);
+		return new Node(contact(string(c.firstName), string(c.lastName), string(c.phoneNumber), string(c.city)),
+			rehydrate(snapshot, rec.left), rehydrate(snapshot, rec.right), rec.balance);
+	}
+	void InOrderPrintToFile(Node* rt, ofstream& outFile) const {
+		if (rt == NULL) {
+			return;
+		}
+		InOrderPrintToFile(rt->left, outFile);
+		outFile << rt->contactInfo.firstName << " " << rt->contactInfo.lastName << " " << rt->contactInfo.phoneNumber << " " << rt->contactInfo.city << endl;
+		InOrderPrintToFile(rt->right, outFile);
+	}
+	void PreOrderPrintToFile(Node* rt, ofstream& outFile) const {
+		if (rt == NULL) {
+			return;
+		}
+		outFile << rt->contactInfo.firstName << " " << rt->contactInfo.lastName << " " << rt->contactInfo.phoneNumber << " " << rt->contactInfo.city << endl;
+		PreOrderPrintToFile(rt->left, outFile);
+		PreOrderPrintToFile(rt->right, outFile);
+	}
+	//Treap manipulations
+	int height(Node* rt) const {
+		if (rt == NULL)
+			return -1;
+		return max(height(rt->left), height(rt->right)) + 1;
+	}
+	void rotateWithLeftChild(Node*& k2) const {
+		Node* k1 = k2->left;
+		k2->left = k1->right;
+		k1->right = k2;
+		k2 = k1;
+	}
+	void rotateWithRightChild(Node*& k1) const {
+		Node* k2 = k1->right;
+		k1->right = k2->left;
+		k2->left = k1;
+		k1 = k2;
+	}
+	void printTree(Node* const& curr, string indent, bool last, ofstream& outFile) const {
+		if (curr == NULL)
+			return;
+
+		outFile << indent;
+		if (last) {
+			outFile << "|__";
+			indent += "   ";
+		}
+		else {
+			outFile << "|--";
+			indent += "|  ";
+		}
+
+		outFile << curr->contactInfo.firstName << " " << curr->contactInfo.lastName << endl;
+
+		printTree(curr->left, indent, curr->right == NULL, outFile);
+		printTree(curr->right, indent, true, outFile);
+	}
+};
+/*End of the Treap class implementation*/
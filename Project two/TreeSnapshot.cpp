@@ -0,0 +1,282 @@
+/*
+Binary snapshot of a built phonebook tree.
+Written by Hagverdi Ibrahimli
+
+Layout of a snapshot file:
+	SnapshotHeader
+	nodeCount x SnapshotRecord, in pre-order (the root is record 0)
+	string pool holding every field of every contact back to back
+A record refers to its strings by (offset, length) into the pool and to its children by record index,
+so the file can be mapped and searched in place, or turned back into a tree in a single pass.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_MAGIC "PBSNAP1"
+#define SNAPSHOT_VERSION 1
+
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nodeCount;
+	uint64_t sourceSize; //size and modification time of the text file the tree was built from
+	int64_t sourceModified;
+	uint64_t poolOffset;
+	uint64_t poolSize;
+};
+
+struct SnapshotRecord {
+	uint32_t offset[4]; //firstName, lastName, phoneNumber, city
+	uint32_t length[4];
+	int32_t left; //record index of the children, -1 if there is none
+	int32_t right;
+	int32_t balance; //engine specific: AVL height, red-black color or treap priority
+	uint32_t reserved;
+};
+
+//Read-only view of a contact stored in a snapshot, pointing into the mapped string pool
+struct contactView {
+	string_view firstName;
+	string_view lastName;
+	string_view phoneNumber;
+	string_view city;
+};
+
+//Size and modification time of a file, used to tell whether a snapshot is still up to date
+bool getSourceStamp(const string& fileName, uint64_t& size, int64_t& modified) {
+	struct stat info;
+	if (stat(fileName.c_str(), &info) != 0)
+		return false;
+	size = info.st_size;
+	modified = info.st_mtime;
+	return true;
+}
+
+//Collects the pre-order records and the string pool of a tree, then writes them in one go
+class SnapshotWriter {
+public:
+	SnapshotWriter() : tooLarge(false) {}
+
+	int addNode(const contact& c, int balance) {
+		SnapshotRecord record;
+		const string* fields[4] = { &c.firstName, &c.lastName, &c.phoneNumber, &c.city };
+		for (int i = 0; i < 4; i++) {
+			//offsets and lengths are 32-bit, and records are indexed by int32_t
+			if (pool.size() + fields[i]->length() > UINT32_MAX || records.size() >= INT32_MAX) {
+				tooLarge = true;
+				record.offset[i] = 0;
+				record.length[i] = 0;
+				continue;
+			}
+			record.offset[i] = pool.size();
+			record.length[i] = fields[i]->length();
+			pool += *fields[i];
+		}
+		record.left = -1;
+		record.right = -1;
+		record.balance = balance;
+		record.reserved = 0;
+		records.push_back(record);
+		return records.size() - 1;
+	}
+	void setChildren(int index, int left, int right) {
+		records[index].left = left;
+		records[index].right = right;
+	}
+	//false if the file cannot be written or the tree does not fit in the format
+	bool writeToFile(const string& fileName, const string& sourceFileName) const {
+		if (tooLarge)
+			return false;
+		SnapshotHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+		header.version = SNAPSHOT_VERSION;
+		header.nodeCount = records.size();
+		if (!getSourceStamp(sourceFileName, header.sourceSize, header.sourceModified))
+			return false;
+		header.poolOffset = sizeof(SnapshotHeader) + records.size() * sizeof(SnapshotRecord);
+		header.poolSize = pool.size();
+
+		ofstream outFile(fileName, ios::binary | ios::trunc);
+		if (!outFile.is_open())
+			return false;
+		outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		outFile.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SnapshotRecord));
+		outFile.write(pool.data(), pool.size());
+		return bool(outFile);
+	}
+private:
+	vector<SnapshotRecord> records;
+	string pool;
+	bool tooLarge; //a string or a record did not fit, the snapshot is not written
+};
+
+//Memory-mapped snapshot file; queries run directly on the mapped records
+class TreeSnapshot {
+public:
+	explicit TreeSnapshot(const string& fileName) : data(NULL), size(0) {
+		open(fileName);
+	}
+	~TreeSnapshot() {
+		close();
+	}
+	TreeSnapshot(const TreeSnapshot&) = delete;
+	TreeSnapshot& operator=(const TreeSnapshot&) = delete;
+
+	bool isOpen() const {
+		return data != NULL;
+	}
+	//true if the snapshot was built from the current version of the given text file
+	bool matchesSource(const string& sourceFileName) const {
+		uint64_t sourceSize;
+		int64_t sourceModified;
+		if (!isOpen() || !getSourceStamp(sourceFileName, sourceSize, sourceModified))
+			return false;
+		return header().sourceSize == sourceSize && header().sourceModified == sourceModified;
+	}
+	int nodeCount() const {
+		return header().nodeCount;
+	}
+	const SnapshotRecord& record(int index) const {
+		return records()[index];
+	}
+	string_view field(const SnapshotRecord& rec, int which) const {
+		return string_view(pool() + rec.offset[which], rec.length[which]);
+	}
+	contactView view(int index) const {
+		const SnapshotRecord& rec = record(index);
+		return contactView{ field(rec, 0), field(rec, 1), field(rec, 2), field(rec, 3) };
+	}
+	//Same search semantics as the trees, answered from the mapped file without building anything
+	template <class Visitor>
+	void forEachMatch(const string& firstName, const string& lastName, Visitor visit) const {
+		if (!isOpen() || nodeCount() == 0)
+			return;
+		const string keyPrefix = firstName + lastName;
+		visitMatches(0, firstName, lastName, keyPrefix, visit);
+	}
+	int countMatches(const string& firstName, const string& lastName) const {
+		int count = 0;
+		forEachMatch(firstName, lastName, [&count](const contactView&) { count++; });
+		return count;
+	}
+private:
+	const char* data;
+	size_t size;
+#ifdef _WIN32
+	vector<char> buffer;
+#endif
+
+	const SnapshotHeader& header() const {
+		return *reinterpret_cast<const SnapshotHeader*>(data);
+	}
+	const SnapshotRecord* records() const {
+		return reinterpret_cast<const SnapshotRecord*>(data + sizeof(SnapshotHeader));
+	}
+	const char* pool() const {
+		return data + header().poolOffset;
+	}
+
+	template <class Visitor>
+	void visitMatches(int index, const string& firstName, const string& lastName, const string& keyPrefix, Visitor& visit) const {
+		if (index < 0)
+			return;
+		const contactView c = view(index);
+		int cmp = compareKeyPrefix(c, keyPrefix);
+		if (cmp >= 0)
+			visitMatches(record(index).left, firstName, lastName, keyPrefix, visit);
+		if (cmp == 0 && isSearchMatch(c, firstName, lastName))
+			visit(c);
+		if (cmp <= 0)
+			visitMatches(record(index).right, firstName, lastName, keyPrefix, visit);
+	}
+
+	void open(const string& fileName) {
+#ifdef _WIN32
+		ifstream inFile(fileName, ios::binary | ios::ate);
+		if (!inFile.is_open())
+			return;
+		buffer.resize(inFile.tellg());
+		inFile.seekg(0, ios::beg);
+		if (!inFile.read(buffer.data(), buffer.size()))
+			return;
+		data = buffer.data();
+		size = buffer.size();
+#else
+		int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0) {
+			void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED) {
+				data = static_cast<const char*>(mapped);
+				size = info.st_size;
+			}
+		}
+		::close(fd);
+#endif
+		if (data != NULL && !isValid())
+			close();
+	}
+	bool isValid() const {
+		if (size < sizeof(SnapshotHeader))
+			return false;
+		const SnapshotHeader& h = header();
+		if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || h.version != SNAPSHOT_VERSION)
+			return false;
+		if (h.poolOffset != sizeof(SnapshotHeader) + uint64_t(h.nodeCount) * sizeof(SnapshotRecord))
+			return false;
+		if (h.poolOffset > size || h.poolSize != size - h.poolOffset)
+			return false;
+		//every string must lie in the pool
+		for (uint32_t i = 0; i < h.nodeCount; i++) {
+			const SnapshotRecord& rec = records()[i];
+			for (int f = 0; f < 4; f++)
+				if (uint64_t(rec.offset[f]) + rec.length[f] > h.poolSize)
+					return false;
+		}
+		return isPreOrderTree(h.nodeCount);
+	}
+	//walks the records from the root in pre-order, which must visit them in index order, each exactly once; so every
+	//subtree spans a contiguous range of records and no record is the child of two others or of itself
+	bool isPreOrderTree(uint32_t nodeCount) const {
+		vector<int32_t> pending; //right children waiting for the left subtrees above them
+		if (nodeCount > 0)
+			pending.push_back(0);
+		uint32_t next = 0;
+		while (!pending.empty()) {
+			const int32_t index = pending.back();
+			pending.pop_back();
+			if (index < 0 || uint32_t(index) != next || next >= nodeCount)
+				return false;
+			next++;
+			const SnapshotRecord& rec = records()[index];
+			if (rec.right != -1)
+				pending.push_back(rec.right);
+			if (rec.left != -1)
+				pending.push_back(rec.left);
+		}
+		return next == nodeCount;
+	}
+	void close() {
+#ifdef _WIN32
+		buffer.clear();
+#else
+		if (data != NULL)
+			munmap(const_cast<char*>(data), size);
+#endif
+		data = NULL;
+		size = 0;
+	}
+};